@@ -735,6 +735,14 @@ bool BamAlignment::HasTag(const std::string& tag) const {
     return FindTag(tag, pTagData, tagDataLength, numBytesParsed);
 }
 
+/*! \fn uint32_t BamAlignment::GetBlockLength(void) const
+    \return the length of the BAM record the alignment was read from, without its length field
+            (0 if it was not read from a BAM file)
+*/
+uint32_t BamAlignment::GetBlockLength(void) const {
+    return SupportData.BlockLength;
+}
+
 /*! \fn bool BamAlignment::IsDuplicate(void) const
     \return \c true if this read is a PCR duplicate
 */
@@ -51,6 +51,10 @@ struct API_EXPORT BamAlignment {
         bool IsReverseStrand(void) const;     // returns true if alignment mapped to reverse strand
         bool IsSecondMate(void) const;        // returns true if alignment is second mate on read
 
+    // size of the alignment in the file
+    public:
+        uint32_t GetBlockLength(void) const;  // returns the length of the BAM record (without its length field), 0 if not read from a BAM file
+
     // manipulate alignment flags
     public:        
         void SetIsDuplicate(bool ok);         // sets value of "PCR duplicate" flag
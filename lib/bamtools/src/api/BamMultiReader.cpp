@@ -375,6 +375,19 @@ bool BamMultiReader::SetExplicitMergeOrder(BamMultiReader::MergeOrder order) {
     return d->SetExplicitMergeOrder(order);
 }
 
+/*! \fn void BamMultiReader::SetReadAhead(int numThreads)
+    \brief Sets the number of threads decompressing each BAM file ahead of the reader.
+
+    Equivalent to calling BamReader::SetReadAhead() on all open BAM files, and on
+    the files opened later.
+
+    \param[in] numThreads number of read-ahead threads per file, 0 disables read-ahead
+    \sa BamReader::SetReadAhead()
+*/
+void BamMultiReader::SetReadAhead(int numThreads) {
+    d->SetReadAhead(numThreads);
+}
+
 /*! \fn bool BamMultiReader::SetRegion(const BamRegion& region)
     \brief Sets a target region of interest
 
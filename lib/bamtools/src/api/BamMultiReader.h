@@ -65,6 +65,8 @@ class API_EXPORT BamMultiReader {
         bool Rewind(void);
         // sets an explicit merge order, regardless of the BAM files' SO header tag
         bool SetExplicitMergeOrder(BamMultiReader::MergeOrder order);
+        // decompresses upcoming blocks of each BAM file with numThreads threads (0 disables read-ahead)
+        void SetReadAhead(int numThreads);
         // sets the target region of interest
         bool SetRegion(const BamRegion& region);
         // sets the target region of interest
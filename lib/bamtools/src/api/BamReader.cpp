@@ -288,6 +288,21 @@ bool BamReader::OpenIndex(const std::string& indexFilename) {
     return d->OpenIndex(indexFilename);
 }
 
+/*! \fn bool BamReader::ClearRegion(void)
+    \brief Clears the target region of interest.
+
+    Unlike Rewind(), the file pointer is not moved: subsequent calls to
+    GetNextAlignment() or GetNextAlignmentCore() return the alignments that
+    follow, up to the end of the BAM file. Useful to go on reading the
+    unplaced reads after the last region of the file.
+
+    \returns \c true if a BAM file is open
+    \sa Jump(), SetRegion()
+*/
+bool BamReader::ClearRegion(void) {
+    return d->ClearRegion();
+}
+
 /*! \fn bool BamReader::Rewind(void)
     \brief Returns the internal file pointer to the first alignment record.
 
@@ -327,6 +342,23 @@ void BamReader::SetIndex(BamIndex* index) {
     d->SetIndex(index);
 }
 
+/*! \fn void BamReader::SetReadAhead(int numThreads)
+    \brief Sets the number of threads decompressing the BAM file ahead of the reader.
+
+    By default BGZF blocks are read & decompressed on the calling thread, when
+    needed. With read-ahead, \a numThreads worker threads read & decompress the
+    next blocks of the file while alignments are being processed. Useful when
+    reading large parts of a BAM file sequentially. Jump(), SetRegion() and
+    Rewind() drop the blocks read ahead so far.
+
+    Can be called before or after Open(); the setting is kept for files opened later.
+
+    \param[in] numThreads number of read-ahead threads, 0 disables read-ahead
+*/
+void BamReader::SetReadAhead(int numThreads) {
+    d->SetReadAhead(numThreads);
+}
+
 /*! \fn bool BamReader::SetRegion(const BamRegion& region)
     \brief Sets a target region of interest
 
@@ -36,6 +36,8 @@ class API_EXPORT BamReader {
         // BAM file operations
         // ----------------------
 
+        // clears the target region of interest, reading goes on from the current position
+        bool ClearRegion(void);
         // closes the current BAM file
         bool Close(void);
         // returns filename of current BAM file
@@ -48,6 +50,8 @@ class API_EXPORT BamReader {
         bool Open(const std::string& filename);
         // returns internal file pointer to beginning of alignment data
         bool Rewind(void);
+        // decompresses upcoming blocks of the BAM file with numThreads threads (0 disables read-ahead)
+        void SetReadAhead(int numThreads);
         // sets the target region of interest
         bool SetRegion(const BamRegion& region);
         // sets the target region of interest
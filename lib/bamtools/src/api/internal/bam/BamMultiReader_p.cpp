@@ -27,6 +27,7 @@ BamMultiReaderPrivate::BamMultiReaderPrivate(void)
     : m_alignmentCache(0)
     , m_hasUserMergeOrder(false)
     , m_mergeOrder(BamMultiReader::RoundRobinMerge)
+    , m_readAheadThreads(0)
 { }
 
 // dtor
@@ -476,6 +477,7 @@ bool BamMultiReaderPrivate::Open(const vector<string>& filenames) {
 
         // attempt to open BamReader
         BamReader* reader = new BamReader;
+        reader->SetReadAhead(m_readAheadThreads);
         const bool readerOpened = reader->Open(filename);
 
         // if opened OK, store it
@@ -695,6 +697,19 @@ bool BamMultiReaderPrivate::SetExplicitMergeOrder(BamMultiReader::MergeOrder ord
     return true;
 }
 
+void BamMultiReaderPrivate::SetReadAhead(int numThreads) {
+
+    m_readAheadThreads = numThreads;
+
+    // apply to all open readers
+    vector<MergeItem>::iterator readerIter = m_readers.begin();
+    vector<MergeItem>::iterator readerEnd  = m_readers.end();
+    for ( ; readerIter != readerEnd; ++readerIter ) {
+        BamReader* reader = (*readerIter).Reader;
+        if ( reader ) reader->SetReadAhead(numThreads);
+    }
+}
+
 void BamMultiReaderPrivate::SetErrorString(const string& where, const string& what) const {
     static const string SEPARATOR = ": ";
     m_errorString = where + SEPARATOR + what;
@@ -59,6 +59,7 @@ class BamMultiReaderPrivate {
         bool GetNextAlignmentCore(BamAlignment& al);
         bool HasOpenReaders(void);
         bool SetExplicitMergeOrder(BamMultiReader::MergeOrder order);
+        void SetReadAhead(int numThreads);
 
         // access auxiliary data
         SamHeader GetHeader(void) const;
@@ -95,6 +96,7 @@ class BamMultiReaderPrivate {
 
         bool m_hasUserMergeOrder;
         BamMultiReader::MergeOrder m_mergeOrder;
+        int m_readAheadThreads;
 
         mutable std::string m_errorString;
 };
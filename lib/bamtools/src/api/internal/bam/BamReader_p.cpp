@@ -278,12 +278,12 @@ bool BamReaderPrivate::LoadNextAlignment(BamAlignment& alignment) {
     // read in character data - make sure proper data size was read
     bool readCharDataOK = false;
     const unsigned int dataLength = alignment.SupportData.BlockLength - Constants::BAM_CORE_SIZE;
-    RaiiBuffer allCharData(dataLength);
 
-    if ( m_stream.Read(allCharData.Buffer, dataLength) == dataLength ) {
+    // read straight into 'allCharData', reusing its memory when the same alignment object is read again
+    string& allCharData = alignment.SupportData.AllCharData;
+    allCharData.resize(dataLength);
 
-        // store 'allCharData' in supportData structure
-        alignment.SupportData.AllCharData.assign((const char*)allCharData.Buffer, dataLength);
+    if ( m_stream.Read(&allCharData[0], dataLength) == dataLength ) {
 
         // set success flag
         readCharDataOK = true;
@@ -292,18 +292,19 @@ bool BamReaderPrivate::LoadNextAlignment(BamAlignment& alignment) {
         // need to calculate this here so that  BamAlignment::GetEndPosition() performs correctly,
         // even when GetNextAlignmentCore() is called
         const unsigned int cigarDataOffset = alignment.SupportData.QueryNameLength;
-        uint32_t* cigarData = (uint32_t*)(allCharData.Buffer + cigarDataOffset);
+        const char* cigarData = allCharData.data() + cigarDataOffset;
         CigarOp op;
         alignment.CigarData.clear();
         alignment.CigarData.reserve(alignment.SupportData.NumCigarOperations);
         for ( unsigned int i = 0; i < alignment.SupportData.NumCigarOperations; ++i ) {
 
-            // swap endian-ness if necessary
-            if ( m_isBigEndian ) BamTools::SwapEndian_32(cigarData[i]);
+            // copy the op, swap endian-ness if necessary (the char data keeps the file byte order)
+            uint32_t cigarValue = BamTools::UnpackUnsignedInt(cigarData + i*sizeof(uint32_t));
+            if ( m_isBigEndian ) BamTools::SwapEndian_32(cigarValue);
 
             // build CigarOp structure
-            op.Length = (cigarData[i] >> Constants::BAM_CIGAR_SHIFT);
-            op.Type   = Constants::BAM_CIGAR_LOOKUP[ (cigarData[i] & Constants::BAM_CIGAR_MASK) ];
+            op.Length = (cigarValue >> Constants::BAM_CIGAR_SHIFT);
+            op.Type   = Constants::BAM_CIGAR_LOOKUP[ (cigarValue & Constants::BAM_CIGAR_MASK) ];
 
             // save CigarOp
             alignment.CigarData.push_back(op);
@@ -453,6 +454,15 @@ void BamReaderPrivate::SetIndex(BamIndex* index) {
 
 // sets current region & attempts to jump to it
 // returns success/failure
+bool BamReaderPrivate::ClearRegion(void) {
+    m_randomAccessController.ClearRegion();
+    return m_stream.IsOpen();
+}
+
+void BamReaderPrivate::SetReadAhead(int numThreads) {
+    m_stream.SetReadAhead(numThreads);
+}
+
 bool BamReaderPrivate::SetRegion(const BamRegion& region) {
 
     if ( m_randomAccessController.SetRegion(region, m_references.size()) )
@@ -47,6 +47,8 @@ class BamReaderPrivate {
         const std::string Filename(void) const;
         bool IsOpen(void) const;
         bool Open(const std::string& filename);
+        bool ClearRegion(void);
+        void SetReadAhead(int numThreads);
         bool Rewind(void);
         bool SetRegion(const BamRegion& region);
 
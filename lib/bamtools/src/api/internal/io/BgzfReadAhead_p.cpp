@@ -0,0 +1,238 @@
+// ***************************************************************************
+// BgzfReadAhead_p.cpp
+// ---------------------------------------------------------------------------
+// Last modified: 16 October 2026
+// ---------------------------------------------------------------------------
+// Provides a ring of BGZF blocks read & decompressed ahead of the consumer
+// by a pool of worker threads
+// ***************************************************************************
+
+#include "api/BamConstants.h"
+#include "api/internal/io/BgzfReadAhead_p.h"
+#include "api/internal/io/BgzfStream_p.h"
+#include "api/internal/utils/BamException_p.h"
+using namespace BamTools;
+using namespace BamTools::Internal;
+
+#include <algorithm>
+using namespace std;
+
+namespace BamTools {
+namespace Internal {
+
+// a block of the ring
+struct BgzfReadAheadSlot {
+
+    enum BlockState { Empty = 0 // not claimed by a worker
+                    , Pending   // being read or decompressed
+                    , Ready     // decompressed data available
+                    , End       // end of file reached
+                    , Failed    // error message in ErrorString
+                    };
+
+    // data members
+    BlockState State;
+    int64_t BlockAddress;
+    int64_t NextBlockAddress;
+    size_t DataLength;
+    std::string ErrorString;
+    RaiiBuffer CompressedBlock;
+    RaiiBuffer UncompressedBlock;
+
+    // ctor
+    BgzfReadAheadSlot(void)
+        : State(Empty)
+        , BlockAddress(0)
+        , NextBlockAddress(0)
+        , DataLength(0)
+        , CompressedBlock(Constants::BGZF_MAX_BLOCK_SIZE)
+        , UncompressedBlock(Constants::BGZF_DEFAULT_BLOCK_SIZE)
+    { }
+};
+
+} // namespace Internal
+} // namespace BamTools
+
+// ---------------------------
+// BgzfReadAhead implementation
+// ---------------------------
+
+// constructor
+BgzfReadAhead::BgzfReadAhead(IBamIODevice* device, const int numThreads)
+    : m_device(device)
+    , m_nextFill(0)
+    , m_nextConsume(0)
+    , m_numInflating(0)
+    , m_isAtEnd(false)
+    , m_isPaused(false)
+    , m_isStopped(false)
+{
+    BT_ASSERT_X( m_device, "BgzfReadAhead::BgzfReadAhead() - read-ahead on null IO device" );
+
+    // a few blocks per thread, so that workers never wait for the consumer on linear reads
+    const int numSlots = 4 * max(numThreads, 1);
+    for ( int i = 0; i < numSlots; ++i )
+        m_slots.push_back(new BgzfReadAheadSlot);
+
+    pthread_mutex_init(&m_mutex, 0);
+    pthread_cond_init(&m_changed, 0);
+
+    for ( int i = 0; i < numThreads; ++i ) {
+        pthread_t worker;
+        if ( pthread_create(&worker, 0, &BgzfReadAhead::WorkerMain, this) == 0 )
+            m_workers.push_back(worker);
+    }
+    if ( m_workers.empty() ) {
+        pthread_cond_destroy(&m_changed);
+        pthread_mutex_destroy(&m_mutex);
+        for ( size_t i = 0; i < m_slots.size(); ++i )
+            delete m_slots[i];
+        throw BamException("BgzfReadAhead::BgzfReadAhead", "could not start read-ahead threads");
+    }
+}
+
+// destructor
+BgzfReadAhead::~BgzfReadAhead(void) {
+
+    // stop & wait for workers
+    pthread_mutex_lock(&m_mutex);
+    m_isStopped = true;
+    pthread_cond_broadcast(&m_changed);
+    pthread_mutex_unlock(&m_mutex);
+    for ( size_t i = 0; i < m_workers.size(); ++i )
+        pthread_join(m_workers[i], 0);
+    m_workers.clear();
+
+    pthread_cond_destroy(&m_changed);
+    pthread_mutex_destroy(&m_mutex);
+
+    for ( size_t i = 0; i < m_slots.size(); ++i )
+        delete m_slots[i];
+    m_slots.clear();
+}
+
+// swaps the next decompressed block into buffer
+bool BgzfReadAhead::NextBlock(char*& buffer, size_t& dataLength, int64_t& blockAddress, int64_t& nextBlockAddress) {
+
+    pthread_mutex_lock(&m_mutex);
+
+    // wait for the block to be read & decompressed
+    BgzfReadAheadSlot* slot = m_slots[m_nextConsume % m_slots.size()];
+    while ( m_nextFill <= m_nextConsume ||
+            slot->State == BgzfReadAheadSlot::Pending )
+    {
+        pthread_cond_wait(&m_changed, &m_mutex);
+    }
+
+    // report errors to the consumer (next calls fail the same way, until Seek())
+    if ( slot->State == BgzfReadAheadSlot::Failed ) {
+        const string message = slot->ErrorString;
+        pthread_mutex_unlock(&m_mutex);
+        throw BamException("BgzfStream::ReadBlock", message);
+    }
+
+    // at end of file, the slot is kept for next calls
+    const bool isReady = ( slot->State == BgzfReadAheadSlot::Ready );
+    if ( isReady ) {
+        swap(buffer, slot->UncompressedBlock.Buffer);
+        dataLength       = slot->DataLength;
+        blockAddress     = slot->BlockAddress;
+        nextBlockAddress = slot->NextBlockAddress;
+        slot->State = BgzfReadAheadSlot::Empty;
+        ++m_nextConsume;
+        pthread_cond_broadcast(&m_changed);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+    return isReady;
+}
+
+// drops all blocks read so far & moves the device to a new block address
+bool BgzfReadAhead::Seek(const int64_t& blockAddress) {
+
+    pthread_mutex_lock(&m_mutex);
+
+    // device is only accessed under the lock, wait for blocks being decompressed
+    m_isPaused = true;
+    while ( m_numInflating > 0 )
+        pthread_cond_wait(&m_changed, &m_mutex);
+
+    const bool seekOk = ( m_device->IsRandomAccess() && m_device->Seek(blockAddress) );
+
+    // reset ring
+    for ( size_t i = 0; i < m_slots.size(); ++i )
+        m_slots[i]->State = BgzfReadAheadSlot::Empty;
+    m_nextFill  = m_nextConsume;
+    m_isAtEnd   = false;
+    m_isPaused  = false;
+    pthread_cond_broadcast(&m_changed);
+
+    pthread_mutex_unlock(&m_mutex);
+    return seekOk;
+}
+
+// worker thread main loop
+void BgzfReadAhead::Work(void) {
+
+    pthread_mutex_lock(&m_mutex);
+    while ( true ) {
+
+        // wait for a free slot
+        while ( !m_isStopped &&
+                ( m_isPaused || m_isAtEnd || m_nextFill - m_nextConsume >= m_slots.size() ) )
+        {
+            pthread_cond_wait(&m_changed, &m_mutex);
+        }
+        if ( m_isStopped )
+            break;
+
+        // claim the next block & read it from the device, blocks are read in file order
+        BgzfReadAheadSlot* slot = m_slots[m_nextFill % m_slots.size()];
+        ++m_nextFill;
+        slot->State = BgzfReadAheadSlot::Pending;
+        size_t blockLength = 0;
+        try {
+            slot->BlockAddress     = m_device->Tell();
+            blockLength            = BgzfStream::ReadBlockData(m_device, slot->CompressedBlock.Buffer);
+            slot->NextBlockAddress = m_device->Tell();
+        } catch ( BamException& e ) {
+            slot->ErrorString = e.what();
+            slot->State = BgzfReadAheadSlot::Failed;
+            m_isAtEnd = true;
+            pthread_cond_broadcast(&m_changed);
+            continue;
+        }
+        if ( blockLength == 0 ) {
+            slot->State = BgzfReadAheadSlot::End;
+            m_isAtEnd = true;
+            pthread_cond_broadcast(&m_changed);
+            continue;
+        }
+
+        // decompress outside the lock
+        ++m_numInflating;
+        pthread_mutex_unlock(&m_mutex);
+        BgzfReadAheadSlot::BlockState state = BgzfReadAheadSlot::Ready;
+        string errorString;
+        try {
+            slot->DataLength = BgzfStream::InflateBlock(slot->CompressedBlock.Buffer,
+                                                        blockLength,
+                                                        slot->UncompressedBlock.Buffer);
+        } catch ( BamException& e ) {
+            errorString = e.what();
+            state = BgzfReadAheadSlot::Failed;
+        }
+        pthread_mutex_lock(&m_mutex);
+        --m_numInflating;
+
+        slot->State = state;
+        slot->ErrorString = errorString;
+        pthread_cond_broadcast(&m_changed);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void* BgzfReadAhead::WorkerMain(void* readAhead) {
+    static_cast<BgzfReadAhead*>(readAhead)->Work();
+    return 0;
+}
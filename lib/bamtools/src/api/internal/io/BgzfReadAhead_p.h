@@ -0,0 +1,76 @@
+// ***************************************************************************
+// BgzfReadAhead_p.h
+// ---------------------------------------------------------------------------
+// Last modified: 16 October 2026
+// ---------------------------------------------------------------------------
+// Provides a ring of BGZF blocks read & decompressed ahead of the consumer
+// by a pool of worker threads
+// ***************************************************************************
+
+#ifndef BGZFREADAHEAD_P_H
+#define BGZFREADAHEAD_P_H
+
+//  -------------
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the BamTools API.  It exists purely as an
+// implementation detail. This header file may change from version to version
+// without notice, or even be removed.
+//
+// We mean it.
+
+#include "api/api_global.h"
+#include "api/BamAux.h"
+#include "api/IBamIODevice.h"
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace BamTools {
+namespace Internal {
+
+struct BgzfReadAheadSlot;
+
+class BgzfReadAhead {
+
+    // constructor & destructor
+    public:
+        BgzfReadAhead(IBamIODevice* device, const int numThreads);
+        ~BgzfReadAhead(void);
+
+    // interface methods
+    public:
+        // swaps the next decompressed block into buffer (BGZF_DEFAULT_BLOCK_SIZE bytes) & returns its data length
+        // and the addresses of this block and of the next one, returns false at end of file
+        bool NextBlock(char*& buffer, size_t& dataLength, int64_t& blockAddress, int64_t& nextBlockAddress);
+        // drops all blocks read so far & moves the device to a new block address
+        bool Seek(const int64_t& blockAddress);
+
+    // internal methods
+    private:
+        // worker thread main loop: reads the next block from the device, then decompresses it
+        void Work(void);
+        static void* WorkerMain(void* readAhead);
+
+    // data members
+    private:
+        IBamIODevice* m_device;
+        std::vector<BgzfReadAheadSlot*> m_slots; // ring of blocks, block number n lives in slot n % size
+        std::vector<pthread_t> m_workers;
+
+        uint64_t m_nextFill;    // number of the next block to read from the device
+        uint64_t m_nextConsume; // number of the next block returned by NextBlock()
+        int  m_numInflating;    // blocks being decompressed outside the lock
+        bool m_isAtEnd;         // no more blocks to read until next Seek()
+        bool m_isPaused;        // Seek() in progress
+        bool m_isStopped;
+
+        pthread_mutex_t m_mutex;
+        pthread_cond_t  m_changed;
+};
+
+} // namespace Internal
+} // namespace BamTools
+
+#endif // BGZFREADAHEAD_P_H
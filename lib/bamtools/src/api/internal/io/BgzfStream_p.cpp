@@ -12,6 +12,7 @@
 #include "api/BamAux.h"
 #include "api/BamConstants.h"
 #include "api/internal/io/BamDeviceFactory_p.h"
+#include "api/internal/io/BgzfReadAhead_p.h"
 #include "api/internal/io/BgzfStream_p.h"
 #include "api/internal/utils/BamException_p.h"
 using namespace BamTools;
@@ -34,8 +35,11 @@ BgzfStream::BgzfStream(void)
   : m_blockLength(0)
   , m_blockOffset(0)
   , m_blockAddress(0)
+  , m_nextBlockAddress(0)
   , m_isWriteCompressed(true)
   , m_device(0)
+  , m_readAheadThreads(0)
+  , m_readAhead(0)
   , m_uncompressedBlock(Constants::BGZF_DEFAULT_BLOCK_SIZE)
   , m_compressedBlock(Constants::BGZF_MAX_BLOCK_SIZE)
 { }
@@ -63,6 +67,10 @@ void BgzfStream::Close(void) {
     // skip if no device open
     if ( m_device == 0 ) return;
 
+    // stop read-ahead before its device goes away
+    delete m_readAhead;
+    m_readAhead = 0;
+
     // if writing to file, flush the current BGZF block,
     // then write an empty block (as EOF marker)
     if ( m_device->IsOpen() && (m_device->Mode() == IBamIODevice::WriteOnly) ) {
@@ -84,6 +92,7 @@ void BgzfStream::Close(void) {
     m_blockLength = 0;
     m_blockOffset = 0;
     m_blockAddress = 0;
+    m_nextBlockAddress = 0;
     m_isWriteCompressed = true;
 }
 
@@ -227,16 +236,16 @@ void BgzfStream::FlushBlock(void) {
     }
 }
 
-// decompresses the current block
-size_t BgzfStream::InflateBlock(const size_t& blockLength) {
+// decompresses a block
+size_t BgzfStream::InflateBlock(const char* compressedBlock, const size_t& blockLength, char* uncompressedBlock) {
 
     // setup zlib stream object
     z_stream zs;
     zs.zalloc    = NULL;
     zs.zfree     = NULL;
-    zs.next_in   = (Bytef*)m_compressedBlock.Buffer + 18;
+    zs.next_in   = (Bytef*)compressedBlock + 18;
     zs.avail_in  = blockLength - 16;
-    zs.next_out  = (Bytef*)m_uncompressedBlock.Buffer;
+    zs.next_out  = (Bytef*)uncompressedBlock;
     zs.avail_out = Constants::BGZF_DEFAULT_BLOCK_SIZE;
 
     // initialize
@@ -323,9 +332,9 @@ size_t BgzfStream::Read(char* data, const size_t dataLength) {
         numBytesRead  += copyLength;
     }
 
-    // update block data
+    // update block data (with read-ahead the device is already past the next block)
     if ( m_blockOffset == m_blockLength ) {
-        m_blockAddress = m_device->Tell();
+        m_blockAddress = ( m_readAhead ? m_nextBlockAddress : m_device->Tell() );
         m_blockOffset  = 0;
         m_blockLength  = 0;
     }
@@ -339,24 +348,65 @@ void BgzfStream::ReadBlock(void) {
 
     BT_ASSERT_X( m_device, "BgzfStream::ReadBlock() - trying to read from null IO device");
 
-    // store block's starting address
-    const int64_t blockAddress = m_device->Tell();
+    int64_t blockAddress = 0;
+    size_t newBlockLength = 0;
+
+    // start read-ahead on first read, if requested
+    if ( m_readAhead == 0 && m_readAheadThreads > 0 && m_device->Mode() == IBamIODevice::ReadOnly ) {
+        m_nextBlockAddress = m_device->Tell();
+        m_readAhead = new BgzfReadAhead(m_device, m_readAheadThreads);
+    }
+
+    // take the next block decompressed by the read-ahead threads
+    if ( m_readAhead ) {
+        if ( !m_readAhead->NextBlock(m_uncompressedBlock.Buffer, newBlockLength, blockAddress, m_nextBlockAddress) ) {
+            m_blockLength = 0;
+            return;
+        }
+    }
+
+    // or read & decompress it here
+    else {
+
+        // store block's starting address
+        blockAddress = m_device->Tell();
+
+        // read block from file
+        const size_t blockLength = ReadBlockData(m_device, m_compressedBlock.Buffer);
+
+        // if block header empty
+        if ( blockLength == 0 ) {
+            m_blockLength = 0;
+            return;
+        }
+
+        // decompress block data
+        newBlockLength = InflateBlock(m_compressedBlock.Buffer, blockLength, m_uncompressedBlock.Buffer);
+    }
+
+    // update block data
+    if ( m_blockLength != 0 )
+        m_blockOffset = 0;
+    m_blockAddress = blockAddress;
+    m_blockLength  = newBlockLength;
+}
+
+// reads the next BGZF block from device
+size_t BgzfStream::ReadBlockData(IBamIODevice* device, char* compressedBlock) {
 
     // read block header from file
     char header[Constants::BGZF_BLOCK_HEADER_LENGTH];
-    int64_t numBytesRead = m_device->Read(header, Constants::BGZF_BLOCK_HEADER_LENGTH);
+    int64_t numBytesRead = device->Read(header, Constants::BGZF_BLOCK_HEADER_LENGTH);
 
     // check for device error
     if ( numBytesRead < 0 ) {
-        const string message = string("device error: ") + m_device->GetErrorString();
+        const string message = string("device error: ") + device->GetErrorString();
         throw BamException("BgzfStream::ReadBlock", message);
     }
 
     // if block header empty
-    if ( numBytesRead == 0 ) {
-        m_blockLength = 0;
-        return;
-    }
+    if ( numBytesRead == 0 )
+        return 0;
 
     // if block header invalid size
     if ( numBytesRead != static_cast<int8_t>(Constants::BGZF_BLOCK_HEADER_LENGTH) )
@@ -368,15 +418,15 @@ void BgzfStream::ReadBlock(void) {
 
     // copy header contents to compressed buffer
     const size_t blockLength = BamTools::UnpackUnsignedShort(&header[16]) + 1;
-    memcpy(m_compressedBlock.Buffer, header, Constants::BGZF_BLOCK_HEADER_LENGTH);
+    memcpy(compressedBlock, header, Constants::BGZF_BLOCK_HEADER_LENGTH);
 
     // read remainder of block
     const size_t remaining = blockLength - Constants::BGZF_BLOCK_HEADER_LENGTH;
-    numBytesRead = m_device->Read(&m_compressedBlock.Buffer[Constants::BGZF_BLOCK_HEADER_LENGTH], remaining);
+    numBytesRead = device->Read(&compressedBlock[Constants::BGZF_BLOCK_HEADER_LENGTH], remaining);
 
     // check for device error
     if ( numBytesRead < 0 ) {
-        const string message = string("device error: ") + m_device->GetErrorString();
+        const string message = string("device error: ") + device->GetErrorString();
         throw BamException("BgzfStream::ReadBlock", message);
     }
 
@@ -384,14 +434,7 @@ void BgzfStream::ReadBlock(void) {
     if ( numBytesRead != static_cast<int64_t>(remaining) )
         throw BamException("BgzfStream::ReadBlock", "could not read data from block");
 
-    // decompress block data
-    const size_t newBlockLength = InflateBlock(blockLength);
-
-    // update block data
-    if ( m_blockLength != 0 )
-        m_blockOffset = 0;
-    m_blockAddress = blockAddress;
-    m_blockLength  = newBlockLength;
+    return blockLength;
 }
 
 // seek to position in BGZF file
@@ -406,13 +449,17 @@ void BgzfStream::Seek(const int64_t& position) {
     int     blockOffset  = (position & 0xFFFF);
     int64_t blockAddress = (position >> 16) & 0xFFFFFFFFFFFFLL;
 
-    // attempt seek in file
-    if ( m_device->IsRandomAccess() && m_device->Seek(blockAddress) ) {
+    // attempt seek in file (read-ahead drops the blocks read so far)
+    const bool seekOk = ( m_readAhead ? m_readAhead->Seek(blockAddress)
+                                      : m_device->IsRandomAccess() && m_device->Seek(blockAddress) );
+    if ( seekOk ) {
 
-        // update block data & return success
+        // update block data & return success (with read-ahead, the next block is now the one sought)
         m_blockLength  = 0;
         m_blockAddress = blockAddress;
         m_blockOffset  = blockOffset;
+        if ( m_readAhead )
+            m_nextBlockAddress = blockAddress;
     }
     else {
         stringstream s("");
@@ -421,6 +468,20 @@ void BgzfStream::Seek(const int64_t& position) {
     }
 }
 
+// sets the number of read-ahead threads, takes effect on next block read
+void BgzfStream::SetReadAhead(const int numThreads) {
+
+    m_readAheadThreads = max(numThreads, 0);
+
+    // drop blocks read ahead so far, device goes back to the first one not consumed yet
+    // (not possible on streamed input, which keeps its current read-ahead)
+    if ( m_readAhead && m_device->IsRandomAccess() ) {
+        delete m_readAhead;
+        m_readAhead = 0;
+        m_device->Seek(m_nextBlockAddress);
+    }
+}
+
 void BgzfStream::SetWriteCompressed(bool ok) {
     m_isWriteCompressed = ok;
 }
@@ -30,6 +30,8 @@
 namespace BamTools {
 namespace Internal {
 
+class BgzfReadAhead;
+
 class BgzfStream {
 
     // constructor & destructor
@@ -49,6 +51,8 @@ class BgzfStream {
         size_t Read(char* data, const size_t dataLength);
         // seek to position in BGZF file
         void Seek(const int64_t& position);
+        // sets the number of threads decompressing upcoming blocks while reading (0 disables read-ahead)
+        void SetReadAhead(const int numThreads);
         // sets IO device (closes previous, if any, but does not attempt to open)
         void SetIODevice(IBamIODevice* device);
         // enable/disable compressed output
@@ -64,8 +68,6 @@ class BgzfStream {
         size_t DeflateBlock(int32_t blockLength);
         // flushes the data in the BGZF block
         void FlushBlock(void);
-        // de-compresses the current block
-        size_t InflateBlock(const size_t& blockLength);
         // reads a BGZF block
         void ReadBlock(void);
 
@@ -73,16 +75,24 @@ class BgzfStream {
     public:
         // checks BGZF block header
         static bool CheckBlockHeader(char* header);
+        // de-compresses a block
+        static size_t InflateBlock(const char* compressedBlock, const size_t& blockLength, char* uncompressedBlock);
+        // reads the next BGZF block from device, returns its compressed length (0 at end of file)
+        static size_t ReadBlockData(IBamIODevice* device, char* compressedBlock);
 
     // data members
     public:
         int32_t m_blockLength;
         int32_t m_blockOffset;
         int64_t m_blockAddress;
+        int64_t m_nextBlockAddress; // address of the block after the current one, with read-ahead
 
         bool m_isWriteCompressed;
         IBamIODevice* m_device;
 
+        int m_readAheadThreads;
+        BgzfReadAhead* m_readAhead;
+
         RaiiBuffer m_uncompressedBlock;
         RaiiBuffer m_compressedBlock;
 };
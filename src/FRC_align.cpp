@@ -21,6 +21,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <list>
 #include <string>
 
 #include <sstream>
@@ -28,17 +30,84 @@
 #include <fstream>
 
 #include  <boost/program_options.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind/bind.hpp>
 namespace po = boost::program_options;
 
 
 #include "data_structures/Features.h"
 #include "data_structures/FRC.h"
+#include "data_structures/FRCurveBuilder.h"
+#include "data_structures/FeatureFile.h"
+#include "data_structures/ContigPipeline.h"
+#include "data_structures/Shards.h"
+#include "data_structures/ContigSummaries.h"
+#include "data_structures/LibrarySampling.h"
+#include "data_structures/LibraryCache.h"
+#include "data_structures/RunReport.h"
 
 #include "common.h"
 
 //LibraryStatistics computeLibraryStats(string bamFileName, uint64_t estimatedGenomeSize, uint32_t max_insert, bool is_mp);
-void computeFRC(FRC &  frc, string bamFileName, LibraryStatistics library,int max_insert, bool is_mp, float CE_min, float CE_max);
-void printFRCurve(string outputFile, int totalFeatNum, FeatureTypes type, uint64_t estimatedGenomeSize, FRC frc);
+void computeFRC(FRC &  frc, string bamFileName, LibraryStatistics library,int max_insert, bool is_mp, float CE_min, float CE_max, unsigned int binSize, unsigned int threads, unsigned int readAhead, string tablePrefix, ContigSummaries *summaries);
+LibraryStatistics libraryStatistics(string bamFileName, uint64_t estimatedGenomeSize, uint32_t max_insert, bool is_mp, unsigned int binSize, unsigned int threads,
+		unsigned int readAhead, float sampleError, bool useCache, ContigSummaries *summaries);
+void printCEstats(string fileName, const CEHistogram &CEstatistics, bool is_mp);
+
+
+// a library to evaluate and its results
+struct libraryRun {
+	string type; // PE or MP
+	string bamFileName;
+	uint32_t max_insert;
+	float CE_min;
+	float CE_max;
+
+	LibraryStatistics library;
+	FRC *frc; // features and CE statistics of this library only
+
+	libraryRun() : max_insert(0), CE_min(0), CE_max(0), frc(NULL) {}
+	libraryRun(string type, string bamFileName, uint32_t max_insert, float CE_min, float CE_max) :
+		type(type), bamFileName(bamFileName), max_insert(max_insert), CE_min(CE_min), CE_max(CE_max), frc(NULL) {}
+};
+
+// parameters shared by all the libraries
+struct librarySettings {
+	uint64_t estimatedGenomeSize;
+	unsigned int binSize;
+	unsigned int threads; // threads of each library
+	unsigned int readAhead;
+	float sampleError;
+	bool useCache;
+	bool singlePass;
+	bool breakpoints; // write the exact FRCurves too
+	string header;
+	string tablePrefix; // of the contig tables, named after the BAM files
+	const FRC *contigs; // contig names and lengths, without features
+};
+
+// an assembly to evaluate: its libraries and, once the header is read, its contigs
+struct assemblyRun {
+	vector<libraryRun> libraries;
+	librarySettings settings; // header, estimated genome size and contigs of this assembly
+	FRC *frc;
+	unsigned int pendingLibraries; // libraries not evaluated yet
+	vector<FRCurve> curves; // set by finishAssembly
+
+	assemblyRun() : frc(NULL), pendingLibraries(0) {}
+};
+
+bool parseLibrary(string specification, uint32_t max_pe_insert, float CE_PE_min, float CE_PE_max, uint32_t max_mp_insert, float CE_MP_min, float CE_MP_max,
+		libraryRun &library);
+void evaluateLibrary(libraryRun *library, unsigned int index, const librarySettings *settings);
+int rankAssemblies(const vector<string> &FRCurvesFiles, string rankingFile);
+int queryFeatures(string featureFile, const vector<string> &regions);
+bool readAssembly(assemblyRun &assembly);
+void finishAssembly(assemblyRun &assembly);
+int evaluateBatch(string manifest, uint32_t max_pe_insert, float CE_PE_min, float CE_PE_max, uint32_t max_mp_insert, float CE_MP_min, float CE_MP_max,
+		const librarySettings &settings, string rankingFile);
+void printPeakMemory(uint64_t maxMemory);
+void writeReport(string reportFile);
 
 
 int main(int argc, char *argv[]) {
@@ -53,8 +122,10 @@ int main(int argc, char *argv[]) {
 	float CEstats_PE_max = +5;
 	float CEstats_MP_min = -7;
 	float CEstats_MP_max = +7;
-	string outputFile =  "FRC.txt";
-	string featureFile = "Features.txt";
+	unsigned int binSize = 1;
+	unsigned int threads = 1;
+	unsigned int readAhead = 0;
+	float sampleError = 0;
 
 	// PROCESS PARAMETERS
 	stringstream ss;
@@ -65,12 +136,26 @@ int main(int argc, char *argv[]) {
 	("pe-max-insert", po::value<int>()   , "maximum allowed insert size for PE (to filter out outleyers)")
 	("mp-sam"       , po::value<string>(), "mate pairs alignment file. (in sam or bam format). Orientation must be <- ->")
 	("mp-max-insert", po::value<int>()   , "maximum allowed insert size for MP (to filter out outleyers)")
+	("library"      , po::value<vector<string> >()->composing(), "one more library, as TYPE,BAM[,MAX_INSERT[,CE_MIN,CE_MAX]] with TYPE PE or MP (can be repeated; maximum insert and CE_stats bounds default to the ones of the type)")
 	("genome-size"  , po::value<unsigned long int>(), "estimated genome size (if not supplied genome size is believed to be assembly length")
 	("output"       ,  po::value<string>(), "Header output file names (default FRC.txt and Features.txt)")
 	("CEstats-PE-min", po::value<float>() , "minimum allowed CE_stats in PE library")
 	("CEstats-PE-max", po::value<float>() , "maximum allowed CE_stats in PE library")
 	("CEstats-MP-min", po::value<float>() , "minimum allowed CE_stats in MP library")
 	("CEstats-MP-max", po::value<float>() , "maximum allowed CE_stats in MP library")
+	("bin-size"      , po::value<unsigned int>(), "keep contig tracks in bins of this many bases, a divisor of 200 (the step of the feature windows, whose sums stay exact and so the features the same); default 1, single base resolution")
+	("threads"       , po::value<unsigned int>(), "number of threads: with several libraries they are evaluated concurrently and the threads are split among them; within a library, with an indexed BAM the references are split among the threads, otherwise alignment reading, track building and feature detection are pipelined (default 1)")
+	("read-ahead"    , po::value<unsigned int>(), "number of threads decompressing the BAM files (or parsing the SAM files) ahead of each reader (default 0, no read-ahead)")
+	("sample-error"  , po::value<float>(), "estimate the library statistics on random regions of an indexed BAM, until insert size mean and std, read coverage and proper pairs coverage are known within this relative error (95% confidence, e.g. 0.01); assemblies shorter than about 40 Mb are read whole, as fast")
+	("single-pass"   , "read every BAM file once: contigs are stored on disk while the library statistics are computed (threads are not used)")
+	("frc-breakpoints", "also write OUTPUT_FRC_breakpoints.txt: the exact FRCurves, contig by contig, of all the feature types")
+	("batch"        , po::value<string>(), "evaluate all the assemblies of a manifest, one per line as OUTPUT_HEADER LIBRARY [LIBRARY ...] with LIBRARY as in --library, on a pool of threads (see threads) evaluating the largest BAM files first; they are ranked into OUTPUT_ranking.txt (use the same genome-size)")
+	("rank"         , po::value<vector<string> >()->multitoken(), "only rank the assemblies whose " FRCURVES_SUFFIX " files (written by previous runs) are given, by the area under their FRCurves, into OUTPUT_ranking.txt")
+	("query-features", po::value<string>(), "only print, as in Features.txt, the features of the regions (see region) from a " FEATURE_FILE_SUFFIX " file written by a previous run")
+	("region"        , po::value<vector<string> >()->composing(), "region to query, as CONTIG or CONTIG:START-END in the coordinates of Features.txt (can be repeated)")
+	("max-memory"    , po::value<unsigned long int>(), "memory budget in MB for the contig tracks (the per base counters, most of the memory of a run): the tracks beyond it are mapped from temporary files in the directory of the output and kept in memory only around the position being processed (default no budget)")
+	("report"        , "also write OUTPUT_report.json: time, items and resident memory of every phase of the run, alignments and bytes read, time per contig with the slowest contigs")
+	("no-stats-cache", "do not load nor store the library statistics in the " LIBRARY_CACHE_SUFFIX " file next to each BAM file")
 	;
 
 	po::variables_map vm;
@@ -87,6 +172,19 @@ int main(int argc, char *argv[]) {
 		exit(0);
 	}
 
+	if (vm.count("rank")) {
+		string header = vm.count("output") ? vm["output"].as<string>() : "";
+		exit(rankAssemblies(vm["rank"].as<vector<string> >(), header + "_ranking.txt"));
+	}
+
+	if (vm.count("query-features")) {
+		vector<string> regions;
+		if (vm.count("region")) {
+			regions = vm["region"].as<vector<string> >();
+		}
+		exit(queryFeatures(vm["query-features"].as<string>(), regions));
+	}
+
 	//PARSE CE STATS (if present)
 	if (vm.count("CEstats-PE-min")) {
 		CEstats_PE_min = vm["CEstats-PE-min"].as<float>();
@@ -101,40 +199,84 @@ int main(int argc, char *argv[]) {
 		CEstats_MP_max = vm["CEstats-MP-max"].as<float>();
 	}
 
-	// PARSE PE
-	if (!vm.count("pe-sam") && !vm.count("mp-sam")) {
-		DEFAULT_CHANNEL << "At least one library must be present. Please specify at least one between pe-sam and mp-sam" << endl;
-		exit(0);
+	if (vm.count("bin-size")) {
+		binSize = vm["bin-size"].as<unsigned int>();
+		if(binSize == 0) {
+			ERROR_CHANNEL << "bin-size must be at least 1" << endl;
+			exit(2);
+		}
+		if(windowResolution(1000, 200) % binSize != 0) { // window borders inside a bin would move and add or lose features
+			ERROR_CHANNEL << "bin-size must divide " << windowResolution(1000, 200) << ", the resolution of the feature windows" << endl;
+			exit(2);
+		}
 	}
 
-	if (vm.count("pe-sam")) {
-		PEalignmentFile = vm["pe-sam"].as<string>();
+	if (vm.count("threads")) {
+		threads = vm["threads"].as<unsigned int>();
+		if(threads == 0) {
+			threads = 1;
+		}
 	}
-	if (vm.count("max-pe-insert")) {
-		max_pe_insert = vm["max-pe-insert"].as<int>();
+
+	if (vm.count("read-ahead")) {
+		readAhead = vm["read-ahead"].as<unsigned int>();
 	}
 
-	// NOW PARSE MP
-	if (vm.count("mp-sam")) {
-		MPalignmentFile = vm["mp-sam"].as<string>();
+	if (vm.count("sample-error")) {
+		sampleError = vm["sample-error"].as<float>();
+		if(sampleError <= 0) {
+			ERROR_CHANNEL << "sample-error must be greater than 0" << endl;
+			exit(2);
+		}
+		if(vm.count("single-pass")) { // the whole file is read anyway
+			cout << "single-pass mode: library statistics are computed on all the alignments, sample-error ignored\n";
+			sampleError = 0;
+		}
 	}
 
+	// PARSE PE
+	if (vm.count("pe-max-insert")) {
+		max_pe_insert = vm["pe-max-insert"].as<int>();
+	}
 	if (vm.count("mp-max-insert")) {
 		max_mp_insert = vm["mp-max-insert"].as<int>();
 	}
-	if(vm.count("pe-sam")){
+
+	vector<libraryRun> libraries;
+	if (vm.count("pe-sam")) {
+		PEalignmentFile = vm["pe-sam"].as<string>();
 		cout << "pe-sam file name is " << PEalignmentFile << endl;
+		libraries.push_back(libraryRun("PE", PEalignmentFile, max_pe_insert, CEstats_PE_min, CEstats_PE_max));
 	}
-	if(vm.count("mp-sam")){
+
+	// NOW PARSE MP
+	if (vm.count("mp-sam")) {
+		MPalignmentFile = vm["mp-sam"].as<string>();
 		cout << "mp-sam file name is " << MPalignmentFile << endl;
+		libraries.push_back(libraryRun("MP", MPalignmentFile, max_mp_insert, CEstats_MP_min, CEstats_MP_max));
 	}
 
+	// AND ALL THE OTHER LIBRARIES
+	if (vm.count("library")) {
+		vector<string> specifications = vm["library"].as<vector<string> >();
+		for(unsigned int i = 0; i < specifications.size(); i++) {
+			libraryRun library;
+			if(!parseLibrary(specifications[i], max_pe_insert, CEstats_PE_min, CEstats_PE_max, max_mp_insert, CEstats_MP_min, CEstats_MP_max, library)) {
+				ERROR_CHANNEL << "wrong library " << specifications[i] << ": expected TYPE,BAM[,MAX_INSERT[,CE_MIN,CE_MAX]] with TYPE PE or MP" << endl;
+				exit(2);
+			}
+			cout << library.type << " library file name is " << library.bamFileName << endl;
+			libraries.push_back(library);
+		}
+	}
+	if(libraries.size() > MAX_LIBRARIES) {
+		ERROR_CHANNEL << "too many libraries: at most " << MAX_LIBRARIES << " per assembly" << endl;
+		exit(2);
+	}
 
 	string header = "";
 	if (vm.count("output")) {
 		header = vm["output"].as<string>();
-		outputFile = header + "_FRC.txt";
-		featureFile = header + "_Features.txt";
 	}
 
 	if (vm.count("genome-size")) {
@@ -143,360 +285,559 @@ int main(int argc, char *argv[]) {
 		estimatedGenomeSize = 0;
 	}
 
+	if (vm.count("report")) {
+		RunReport::enable();
+	}
+
+	uint64_t maxMemory = 0;
+	if (vm.count("max-memory")) {
+		maxMemory = vm["max-memory"].as<unsigned long int>() << 20;
+		if(maxMemory == 0) {
+			ERROR_CHANNEL << "max-memory must be at least 1" << endl;
+			exit(2);
+		}
+		string spillDirectory = boost::filesystem::path(header).parent_path().string();
+		TrackArena::setMemoryBudget(maxMemory, spillDirectory);
+		cout << "tracks over " << (maxMemory >> 20) << " MB are mapped from temporary files in " << (spillDirectory.empty() ? "." : spillDirectory) << "\n";
+	}
+
+	librarySettings settings;
+	settings.estimatedGenomeSize = estimatedGenomeSize; // 0: the assembly length
+	settings.binSize     = binSize;
+	settings.threads     = threads;
+	settings.readAhead   = readAhead;
+	settings.sampleError = sampleError;
+	settings.useCache    = !vm.count("no-stats-cache");
+	settings.singlePass  = vm.count("single-pass");
+	settings.breakpoints = vm.count("frc-breakpoints");
+	settings.header      = header;
+	settings.tablePrefix = "";
+	settings.contigs     = NULL;
+
+	if (vm.count("batch")) {
+		if (!libraries.empty()) {
+			cout << "batch mode: only the libraries of the manifest are evaluated\n";
+		}
+		int status = evaluateBatch(vm["batch"].as<string>(), max_pe_insert, CEstats_PE_min, CEstats_PE_max, max_mp_insert, CEstats_MP_min, CEstats_MP_max,
+				settings, header + "_ranking.txt");
+		printPeakMemory(maxMemory);
+		writeReport(header + "_report.json");
+		exit(status);
+	}
+
+	if (libraries.empty()) {
+		DEFAULT_CHANNEL << "At least one library must be present. Please specify at least one between pe-sam, mp-sam and library" << endl;
+		exit(0);
+	}
+
 	//TODO: PARSING ENDED, CREATE A FUNCTION FOR IT
+	assemblyRun assembly;
+	assembly.libraries = libraries;
+	assembly.settings  = settings;
+	if(!readAssembly(assembly)) {
+		exit(2);
+	}
+
+	// Libraries can now be evaluated
+	if(threads > 1 and libraries.size() > 1) { // every library on its own threads, the threads are split among the libraries
+		assembly.settings.threads = max(1u, threads / (unsigned int)libraries.size());
+		cout << "evaluating " << libraries.size() << " libraries concurrently, " << assembly.settings.threads << " threads each\n";
+		boost::thread_group pool;
+		for(unsigned int i = 0; i < libraries.size(); i++) {
+			pool.create_thread(boost::bind(&evaluateLibrary, &assembly.libraries[i], i, &assembly.settings));
+		}
+		pool.join_all();
+	} else {
+		for(unsigned int i = 0; i < libraries.size(); i++) {
+			evaluateLibrary(&assembly.libraries[i], i, &assembly.settings);
+		}
+	}
+
+	finishAssembly(assembly);
+	printPeakMemory(maxMemory);
+	writeReport(header + "_report.json");
+
+    return 0;
+}
+
+
+
+// contig names and lengths of the assembly, from the header of its first library
+bool readAssembly(assemblyRun &assembly) {
+	PhaseClock clock;
 	uint64_t genomeLength = 0;
 	uint32_t contigsNumber = 0;
-	BamReader bamFile;
-	if(vm.count("pe-sam")) { // paired read library is preset, use it to compute basic contig statistics
-		bamFile.Open(PEalignmentFile);
-	} else {  // Otherwise use MP library that must be provided
-		bamFile.Open(PEalignmentFile);
+	AlignmentReader bamFile;
+	if(!bamFile.Open(assembly.libraries[0].bamFileName)) { // all the libraries are aligned against the same assembly, use the first one to compute basic contig statistics
+		ERROR_CHANNEL << "cannot open " << assembly.libraries[0].bamFileName << endl;
+		return false;
 	}
 
-
 	SamHeader head = bamFile.GetHeader();
-	map<string,unsigned int> contig2position;
-	map<unsigned int,string> position2contig;
 	SamSequenceDictionary sequences  = head.Sequences;
 	for(SamSequenceIterator sequence = sequences.Begin() ; sequence != sequences.End(); ++sequence) {
 		genomeLength += StringToNumber(sequence->Length);
-		contig2position[sequence->Name] = contigsNumber; // keep track of contig name and position in order to avoid problems when processing two libraries
-		position2contig[contigsNumber] = contig2position[sequence->Name];
 		contigsNumber++;
 	}
 	bamFile.Close();
 
-	if (estimatedGenomeSize == 0) {
-		estimatedGenomeSize =  genomeLength;
+	if (assembly.settings.estimatedGenomeSize == 0) {
+		assembly.settings.estimatedGenomeSize =  genomeLength;
 	}
 
 	cout << "#contigs: " 	<< contigsNumber << endl;
 	cout << "assembly length: " 			<< genomeLength << "\n";
-	cout << "estimated length: "    		<< estimatedGenomeSize << "\n";
-
-	LibraryStatistics libraryPE;
-	LibraryStatistics libraryMP;
-	uint32_t		  peInsertSize;
-	uint32_t 		  peStdDeviation;
-	uint32_t 		  mpInsertSize;
-	uint32_t 		  mpStdDeviation;
-	unsigned int      timesStdDev = 3;
+	cout << "estimated length: "    		<< assembly.settings.estimatedGenomeSize << "\n";
 
-	if(vm.count("pe-sam")) { // in this case file is already OPEN
-		cout << "computing statistics for PE library\n";
-		libraryPE = computeLibraryStats(PEalignmentFile, estimatedGenomeSize, max_pe_insert, false);
+	assembly.frc = new FRC(contigsNumber); // FRC object, will memorize all information on features and contigs
+	uint32_t contigCounter = 0;
+	for(SamSequenceIterator sequence = sequences.Begin() ; sequence != sequences.End(); ++sequence) {
+		uint32_t contigLength = StringToNumber(sequence->Length);
+		assembly.frc->setContigLength(contigCounter, contigLength);
+		assembly.frc->setID(contigCounter, sequence->Name);
+		contigCounter++;
 	}
+	assembly.settings.contigs = assembly.frc;
+	assembly.pendingLibraries = assembly.libraries.size();
+	clock.lap(PHASE_HEADER);
+	return true;
+}
 
-	if(vm.count("mp-sam")) {
-		cout << "computing statistics for MP library\n";
-		if(!vm.count("pe-sam")) { // in this case file is already OPEN
-			libraryMP = computeLibraryStats(MPalignmentFile, estimatedGenomeSize, max_mp_insert, true);
-		} else { // in this case I need to open file first
-			libraryMP = computeLibraryStats(MPalignmentFile, estimatedGenomeSize, max_mp_insert, true);
-		}
-	}
+
+// merges the features of the libraries of the assembly (all evaluated) and writes all its outputs
+void finishAssembly(assemblyRun &assembly) {
+	string header = assembly.settings.header;
+	uint64_t estimatedGenomeSize = assembly.settings.estimatedGenomeSize;
+	vector<libraryRun> &libraries = assembly.libraries;
+	FRC &frc = *assembly.frc;
+	unsigned int contigsNumber = frc.returnContigs();
+	PhaseClock clock;
+	string outputFile  = header == "" ? "FRC.txt" : header + "_FRC.txt";
+	string featureFile = header == "" ? "Features.txt" : header + "_Features.txt";
 
 	//Store library stats in tabular format
-	ofstream AssemblyMetricsFile; // This file descriptor will contain statistics for the all assembly
+	TextWriter AssemblyMetricsFile; // This file descriptor will contain statistics for the all assembly
 	string   AssemblyMetricsFileName = header + "_assemblyTable.csv";
-	AssemblyMetricsFile.open(AssemblyMetricsFileName.c_str());
-	if(vm.count("pe-sam")) {
-		print_AssemblyMetrics(libraryPE, "PE", AssemblyMetricsFile);
-	}
-
-	if(vm.count("mp-sam")) {
-		print_AssemblyMetrics(libraryMP, "MP", AssemblyMetricsFile);
-	}
-
-
-	// Libraries have been parsed, now I need to compute new maximum and minimum for pe and mp and compute features
-
-	//parse BAM file again to compute FRC curve
-	FRC frc = FRC(contigsNumber); // FRC object, will memorize all information on features and contigs
-	uint32_t contigCounter = 0;
-	for(SamSequenceIterator sequence = sequences.Begin() ; sequence != sequences.End(); ++sequence) {
-		uint32_t contigLength = StringToNumber(sequence->Length);
-		frc.setContigLength(contigCounter, contigLength);
-		frc.setID(contigCounter, sequence->Name);
-		contigCounter++;
+	AssemblyMetricsFile.open(AssemblyMetricsFileName);
+	for(unsigned int i = 0; i < libraries.size(); i++) {
+		print_AssemblyMetrics(libraries[i].library, libraries[i].type, AssemblyMetricsFile);
 	}
+	AssemblyMetricsFile.close();
 
+	// the features of every library are merged in the FRC object
 	int featuresTotal   = 0;
-	int featuresTotalPE = 0;
-	int featuresTotalMP = 0;
-
-	if(vm.count("pe-sam")) { // in this case file is already OPEN
-		cout << "computing Features for PE library\n";
-		// here add a new file descriptor for contig stats
-
-		computeFRC(frc, PEalignmentFile, libraryPE, max_pe_insert, false, CEstats_PE_min , CEstats_PE_max);
-		string PE_CEstats = header + "_CEstats_PE.txt";
-		ofstream CEstats;
-		CEstats.open(PE_CEstats.c_str());
-		map<float, unsigned int>::iterator it;
-		map<float, unsigned int>::iterator secondIterator;
-		for ( it = frc.CEstatistics.begin() ; it != frc.CEstatistics.end(); it++ ) {
-			unsigned int total = 0;
-			if( (*it).first < 0) {
-				for(secondIterator = it; secondIterator != frc.CEstatistics.begin(); secondIterator --) {
-					total += (*secondIterator).second;
-				}
-			} else {
-				for(secondIterator = it; secondIterator != frc.CEstatistics.end(); secondIterator ++) {
-					total += (*secondIterator).second;
-				}
-			}
-			CEstats << (*it).first << " " << total << endl;
-		}
-		CEstats.close();
-		frc.CEstatistics.clear();
-		for(unsigned int i=0; i< contigsNumber; i++) {
-			featuresTotal   += frc.getTotal(i);
-			featuresTotalPE += frc.getTotal(i);
-		}
+	map<string, unsigned int> librariesPerType;
+	for(unsigned int i = 0; i < libraries.size(); i++) {
+		librariesPerType[libraries[i].type]++;
 	}
-
-
-	//NOW MP
-	if(vm.count("mp-sam")) {
-		cout << "computing Features for MP library\n";
-		computeFRC(frc, MPalignmentFile, libraryMP, max_mp_insert, true, CEstats_MP_min , CEstats_MP_max);
-		string MP_CEstats = header + "_CEstats_MP.txt";
-		ofstream CEstats;
-		CEstats.open(MP_CEstats.c_str());
-		map<float, unsigned int>::iterator it;
-		map<float, unsigned int>::iterator secondIterator;
-		for ( it= frc.CEstatistics.begin() ; it != frc.CEstatistics.end(); it++ ) {
-			unsigned int total = 0;
-			if( (*it).first <= 0) {
-				for(secondIterator = it; secondIterator != frc.CEstatistics.begin(); secondIterator --) {
-					total += (*secondIterator).second;
-				}
-				CEstats << (*it).first << " " << total << endl;
-			} else {
-				for(secondIterator = it; secondIterator != frc.CEstatistics.end(); secondIterator ++) {
-					total += (*secondIterator).second;
-				}
-				CEstats << (*it).first << " " << total << endl;
+	set<string> CEstatsFileNames;
+	for(unsigned int i = 0; i < libraries.size(); i++) {
+		libraryRun &library = libraries[i];
+		string CEstatsFileName = header + "_CEstats_" + library.type + ".txt";
+		if(librariesPerType[library.type] > 1) { // one file per library, named after its BAM file (and position, if the BAM file is used twice)
+			CEstatsFileName = header + "_CEstats_" + library.type + "_" + library.library.library_name + ".txt";
+			if(CEstatsFileNames.count(CEstatsFileName)) {
+				stringstream name;
+				name << header << "_CEstats_" << library.type << "_" << library.library.library_name << "_" << i + 1 << ".txt";
+				CEstatsFileName = name.str();
 			}
+			CEstatsFileNames.insert(CEstatsFileName);
 		}
-		CEstats.close();
-		frc.CEstatistics.clear();
+		printCEstats(CEstatsFileName, library.frc->CEstatistics, library.type == "MP");
+		frc.mergeFeatures(*library.frc);
+		delete library.frc;
+		library.frc = NULL;
 		for(unsigned int i=0; i< contigsNumber; i++) {
 			featuresTotal   += frc.getTotal(i);
-			featuresTotalMP += frc.getTotal(i);
 		}
 	}
 	//all features have now been computed
 
 	//print all features
-	ofstream featureOutFile;
-	featureOutFile.open (featureFile.c_str());
-	ofstream GFF3_features;
+	TextWriter featureOutFile;
+	featureOutFile.open(featureFile, true);
+	TextWriter GFF3_features;
 	string GFF3 = header + "Features.gff";
-	GFF3_features.open(GFF3.c_str());
+	GFF3_features.open(GFF3, true);
 	GFF3_features << "##gff-version   3\n";
     for(unsigned int i=0; i< contigsNumber; i++) {
     	frc.printFeatures(i, featureOutFile);
     	frc.printFeaturesGFF3(i, GFF3_features);
     }
+    featureOutFile.close();
+    GFF3_features.close();
+    // the same features, indexed for region queries (see --query-features)
+    if(!writeFeatureFile(header + FEATURE_FILE_SUFFIX, frc)) {
+    	ERROR_CHANNEL << "cannot write " << header << FEATURE_FILE_SUFFIX << endl;
+    }
+    clock.lap(PHASE_OUTPUT);
 
-    frc.sortFRC();
+    FRCurveBuilder curves(frc); // contigs are sorted by length once, for all the curves
 
     //NOW COMPUTE ALL THE FRCurves
-    unsigned int LOW_COV_PE_features = 0;
-    unsigned int HIGH_COV_PE_features = 0;
-    unsigned int LOW_NORM_COV_PE_features = 0;
-    unsigned int HIGH_NORM_COV_PE_features = 0;
-    unsigned int HIGH_SINGLE_PE_features = 0;
-    unsigned int HIGH_SPAN_PE_features = 0;
-    unsigned int HIGH_OUTIE_PE_features = 0;
-    unsigned int COMPR_PE_features = 0;
-    unsigned int STRECH_PE_features = 0;
-
-    unsigned int HIGH_SINGLE_MP_features = 0;
-    unsigned int HIGH_OUTIE_MP_features = 0;
-    unsigned int HIGH_SPAN_MP_features = 0;
-    unsigned int COMPR_MP_features = 0;
-    unsigned int STRECH_MP_features = 0;
+    featuresTotal += curves.totalFeatures(FRC_TOTAL); // update total number of feature seen so far
+    unsigned int LOW_COV_PE_features = curves.totalFeatures(LOW_COV_PE);
+
+    curves.printFRCurve(outputFile, featuresTotal, FRC_TOTAL, estimatedGenomeSize);
+    //now all the others, all stepping by the number of LOW_COV_PE features
+    for(unsigned int type = LOW_COV_PE; type < FEATURE_TYPES; type++) {
+    	outputFile = header + returnFeatureName((FeatureTypes)type) + "_FRC.txt";
+    	curves.printFRCurve(outputFile, LOW_COV_PE_features, (FeatureTypes)type, estimatedGenomeSize);
+    }
 
-    for(unsigned int i=0; i< contigsNumber; i++) {
-    	featuresTotal += frc.getTotal(i); // update total number of feature seen so far
-    	LOW_COV_PE_features += frc.getLOW_COV_PE(i);
-    	HIGH_COV_PE_features += frc.getHIGH_COV_PE(i);
-    	LOW_NORM_COV_PE_features += frc.getLOW_NORM_COV_PE(i);
-    	HIGH_NORM_COV_PE_features += frc.getHIGH_NORM_COV_PE(i);
-    	HIGH_SINGLE_PE_features += frc.getHIGH_SINGLE_PE(i);
-    	HIGH_SPAN_PE_features += frc.getHIGH_SPAN_PE(i);
-    	HIGH_OUTIE_PE_features += frc.getHIGH_OUTIE_PE(i);
-    	COMPR_PE_features += frc.getCOMPR_PE(i);
-    	STRECH_PE_features += frc.getSTRECH_PE(i);
-
-    	HIGH_SINGLE_MP_features += frc.getHIGH_SINGLE_MP(i);
-    	HIGH_OUTIE_MP_features += frc.getHIGH_OUTIE_MP(i);
-    	HIGH_SPAN_MP_features += frc.getHIGH_SPAN_MP(i);
-    	COMPR_MP_features += frc.getCOMPR_MP(i);
-    	STRECH_MP_features += frc.getSTRECH_MP(i);
+    if(assembly.settings.breakpoints) {
+    	curves.printBreakpoints(header + "_FRC_breakpoints.txt", estimatedGenomeSize);
     }
 
-    printFRCurve(outputFile, featuresTotal, FRC_TOTAL, estimatedGenomeSize, frc);
-    //now all the others
-    outputFile = header + "LOW_COV_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, LOW_COV_PE, estimatedGenomeSize, frc);
+    // the same curves, compact, to rank this assembly against other ones (see --rank)
+    assembly.curves.clear();
+    for(unsigned int type = FRC_TOTAL; type < FEATURE_TYPES; type++) {
+    	assembly.curves.push_back(curves.curve((FeatureTypes)type, estimatedGenomeSize));
+    }
+    if(!writeFRCurves(header + FRCURVES_SUFFIX, assembly.curves)) {
+    	ERROR_CHANNEL << "cannot write " << header << FRCURVES_SUFFIX << endl;
+    }
+    clock.lap(PHASE_CURVES);
 
-    outputFile = header + "HIGH_COV_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_COV_PE, estimatedGenomeSize, frc);
+    delete assembly.frc;
+    assembly.frc = NULL;
+    assembly.settings.contigs = NULL;
+}
 
-    outputFile = header + "LOW_NORM_COV_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, LOW_NORM_COV_PE, estimatedGenomeSize, frc);
 
-    outputFile = header + "HIGH_NORM_COV_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_NORM_COV_PE, estimatedGenomeSize, frc);
 
-    outputFile = header + "HIGH_SINGLE_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_SINGLE_PE, estimatedGenomeSize, frc);
+// a library of an assembly of the batch
+struct batchJob {
+	assemblyRun *assembly;
+	unsigned int library;
+	uint64_t size; // BAM file size, the expected work
+};
 
-    outputFile = header + "HIGH_OUTIE_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_OUTIE_PE, estimatedGenomeSize, frc);
+struct longerJob {
+	bool operator()(const batchJob &a, const batchJob &b) const {
+		return a.size > b.size;
+	}
+};
+
+// the jobs of the batch, handed out in order to the workers
+struct batchSchedule {
+	vector<batchJob> jobs;
+	unsigned int next;
+	boost::mutex lock;
+};
+
+// evaluates libraries until none is left; the worker finishing the last library of an assembly also writes its outputs
+static void batchWorker(batchSchedule *schedule) {
+	while(true) {
+		batchJob job;
+		{
+			boost::unique_lock<boost::mutex> guard(schedule->lock);
+			if(schedule->next == schedule->jobs.size()) {
+				return;
+			}
+			job = schedule->jobs[schedule->next++];
+		}
+		evaluateLibrary(&job.assembly->libraries[job.library], job.library, &job.assembly->settings);
+		bool last;
+		{
+			boost::unique_lock<boost::mutex> guard(schedule->lock);
+			last = --job.assembly->pendingLibraries == 0;
+		}
+		if(last) {
+			finishAssembly(*job.assembly);
+		}
+	}
+}
 
-    outputFile = header + "HIGH_SPAN_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_SPAN_PE, estimatedGenomeSize, frc);
 
-    outputFile = header + "COMPR_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, COMPR_PE, estimatedGenomeSize, frc);
+int evaluateBatch(string manifest, uint32_t max_pe_insert, float CE_PE_min, float CE_PE_max, uint32_t max_mp_insert, float CE_MP_min, float CE_MP_max,
+		const librarySettings &settings, string rankingFile) {
+	ifstream manifestFile(manifest.c_str());
+	if(!manifestFile) {
+		ERROR_CHANNEL << "cannot open " << manifest << endl;
+		return 2;
+	}
+	list<assemblyRun> assemblies; // never moved: jobs point to them
+	string line;
+	while(getline(manifestFile, line)) {
+		stringstream fields(line);
+		string field;
+		if(!(fields >> field) or field[0] == '#') {
+			continue;
+		}
+		assemblyRun assembly;
+		assembly.settings        = settings;
+		assembly.settings.header = field;
+		assembly.settings.tablePrefix = field + "_"; // assemblies can share BAM file names
+		while(fields >> field) {
+			libraryRun library;
+			if(!parseLibrary(field, max_pe_insert, CE_PE_min, CE_PE_max, max_mp_insert, CE_MP_min, CE_MP_max, library)) {
+				ERROR_CHANNEL << "wrong library " << field << " of assembly " << assembly.settings.header << endl;
+				return 2;
+			}
+			assembly.libraries.push_back(library);
+		}
+		if(assembly.libraries.empty()) {
+			ERROR_CHANNEL << "no libraries for assembly " << assembly.settings.header << endl;
+			return 2;
+		}
+		if(assembly.libraries.size() > MAX_LIBRARIES) {
+			ERROR_CHANNEL << "too many libraries for assembly " << assembly.settings.header << ": at most " << MAX_LIBRARIES << endl;
+			return 2;
+		}
+		assemblies.push_back(assembly);
+	}
+	if(settings.estimatedGenomeSize == 0) {
+		cout << "batch mode without genome-size: every assembly is evaluated on its own length, the ranking is not meaningful\n";
+	}
 
-    outputFile = header + "STRECH_PE_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, STRECH_PE, estimatedGenomeSize, frc);
+	batchSchedule schedule;
+	schedule.next = 0;
+	for(list<assemblyRun>::iterator assembly = assemblies.begin(); assembly != assemblies.end(); ++assembly) {
+		cout << "assembly " << assembly->settings.header << "\n";
+		if(!readAssembly(*assembly)) {
+			return 2;
+		}
+		for(unsigned int i = 0; i < assembly->libraries.size(); i++) {
+			batchJob job;
+			job.assembly = &*assembly;
+			job.library  = i;
+			boost::system::error_code error;
+			job.size     = boost::filesystem::file_size(assembly->libraries[i].bamFileName, error);
+			schedule.jobs.push_back(job);
+		}
+	}
+	stable_sort(schedule.jobs.begin(), schedule.jobs.end(), longerJob()); // longest first, the short ones fill the gaps at the end
 
+	// every worker evaluates one library at a time; with more threads than libraries each library gets the spare ones
+	unsigned int workers = min(settings.threads, (unsigned int)schedule.jobs.size());
+	for(list<assemblyRun>::iterator assembly = assemblies.begin(); assembly != assemblies.end(); ++assembly) {
+		assembly->settings.threads = max(1u, settings.threads / (unsigned int)schedule.jobs.size());
+	}
+	cout << "evaluating " << assemblies.size() << " assemblies, " << schedule.jobs.size() << " libraries on " << workers << " threads\n";
+	boost::thread_group pool;
+	for(unsigned int i = 0; i < workers; i++) {
+		pool.create_thread(boost::bind(&batchWorker, &schedule));
+	}
+	pool.join_all();
 
-    outputFile = header + "HIGH_SINGLE_MP_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_SINGLE_MP, estimatedGenomeSize, frc);
+	vector<string> names;
+	vector<vector<FRCurve> > curves;
+	for(list<assemblyRun>::iterator assembly = assemblies.begin(); assembly != assemblies.end(); ++assembly) {
+		names.push_back(assembly->settings.header);
+		curves.push_back(assembly->curves);
+	}
+	ofstream ranking;
+	ranking.open(rankingFile.c_str());
+	printRanking(ranking, names, curves);
+	printRanking(cout, names, curves);
+	ranking.close();
+	return 0;
+}
 
-    outputFile = header + "HIGH_OUTIE_MP_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_OUTIE_MP, estimatedGenomeSize, frc);
 
-    outputFile = header + "HIGH_SPAN_MP_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, HIGH_SPAN_MP, estimatedGenomeSize, frc);
 
-    outputFile = header + "COMPR_MP_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, COMPR_MP, estimatedGenomeSize, frc);
+// TYPE,BAM[,MAX_INSERT[,CE_MIN,CE_MAX]]: missing values are the ones of the type
+bool parseLibrary(string specification, uint32_t max_pe_insert, float CE_PE_min, float CE_PE_max, uint32_t max_mp_insert, float CE_MP_min, float CE_MP_max,
+		libraryRun &library) {
+	vector<string> fields;
+	stringstream ss(specification);
+	string field;
+	while(getline(ss, field, ',')) {
+		fields.push_back(field);
+	}
+	if(fields.size() != 2 and fields.size() != 3 and fields.size() != 5) {
+		return false;
+	}
+	string type = fields[0];
+	transform(type.begin(), type.end(), type.begin(), ::toupper);
+	if(type == "PE") {
+		library = libraryRun("PE", fields[1], max_pe_insert, CE_PE_min, CE_PE_max);
+	} else if(type == "MP") {
+		library = libraryRun("MP", fields[1], max_mp_insert, CE_MP_min, CE_MP_max);
+	} else {
+		return false;
+	}
+	if(fields.size() >= 3) {
+		stringstream value(fields[2]);
+		if(!(value >> library.max_insert)) {
+			return false;
+		}
+	}
+	if(fields.size() == 5) {
+		stringstream min(fields[3]), max(fields[4]);
+		if(!(min >> library.CE_min) or !(max >> library.CE_max)) {
+			return false;
+		}
+	}
+	return library.bamFileName != "";
+}
 
-    outputFile = header + "STRECH_MP_FRC.txt";
-    printFRCurve(outputFile, LOW_COV_PE_features, STRECH_MP, estimatedGenomeSize, frc);
 
+// statistics and features of a library, the features are stored in a FRC object of its own
+void evaluateLibrary(libraryRun *library, unsigned int index, const librarySettings *settings) {
+	bool is_mp = library->type == "MP";
+	ContigSummaries *summaries = NULL;
+	if(settings->singlePass) {
+		stringstream spill;
+		spill << settings->header << "_" << library->type << "_" << index << "_contigs.tmp";
+		summaries = new ContigSummaries(spill.str());
+	}
 
-    return 0;
+	cout << "computing statistics for " << library->type << " library " << library->bamFileName << "\n";
+	PhaseClock clock;
+	library->library = libraryStatistics(library->bamFileName, settings->estimatedGenomeSize, library->max_insert, is_mp, settings->binSize,
+			settings->threads, settings->readAhead, settings->sampleError, settings->useCache, summaries);
+	clock.lap(PHASE_STATISTICS);
+
+	cout << "computing Features for " << library->type << " library " << library->bamFileName << "\n";
+	library->frc = new FRC(*settings->contigs);
+	library->frc->setLibrary(index);
+	computeFRC(*library->frc, library->bamFileName, library->library, library->max_insert, is_mp, library->CE_min, library->CE_max,
+			settings->binSize, settings->threads, settings->readAhead, settings->tablePrefix, summaries);
+	delete summaries;
 }
 
 
+// CE statistics cumulated from the center: values below 0 (or 0 for MP) count the ones at their left, the others the ones at their right
+void printCEstats(string fileName, const CEHistogram &CEstatistics, bool is_mp) {
+	TextWriter CEstats;
+	CEstats.open(fileName);
+	CEstatistics.printCumulative(CEstats, is_mp);
+	CEstats.close();
+}
+
 
-int getFeatures(FRC frc, FeatureTypes type, int contig) {
-	switch (type) {
-		 case FRC_TOTAL:
-			 return frc.getTotal(contig);
-			 break;
-		 case LOW_COV_PE:
-			 return frc.getLOW_COV_PE(contig);
-			 break;
-		 case HIGH_COV_PE:
-			 return frc.getHIGH_COV_PE(contig);
-			 break;
-		 case LOW_NORM_COV_PE:
-			 return frc.getLOW_NORM_COV_PE(contig);
-			 break;
-		 case HIGH_NORM_COV_PE:
-			 return frc.getHIGH_NORM_COV_PE(contig);
-			 break;
-		 case HIGH_SINGLE_PE:
-			 return frc.getHIGH_SINGLE_PE(contig);
-			 break;
-		 case HIGH_SPAN_PE:
-			 return frc.getHIGH_SPAN_PE(contig);
-			 break;
-		 case HIGH_OUTIE_PE:
-			 return frc.getHIGH_OUTIE_PE(contig);
-			 break;
-		 case COMPR_PE:
-			 return frc.getCOMPR_PE(contig);
-			 break;
-		 case STRECH_PE:
-			 return frc.getSTRECH_PE(contig);
-			 break;
-		 case HIGH_SINGLE_MP:
-			 return frc.getHIGH_SINGLE_MP(contig);
-			 break;
-		 case HIGH_OUTIE_MP:
-			 return frc.getHIGH_OUTIE_MP(contig);
-			 break;
-		 case HIGH_SPAN_MP:
-			 return frc.getHIGH_SPAN_MP(contig);
-			 break;
-		 case COMPR_MP:
-			 return frc.getCOMPR_MP(contig);
-			 break;
-		 case STRECH_MP:
-			 return frc.getSTRECH_MP(contig);
-			 break;
-		 default:
-			 cout << "THis whould never happen\n";
+// peak resident set of the run, against the budget of --max-memory (if given)
+void printPeakMemory(uint64_t maxMemory) {
+	if(maxMemory == 0) {
+		return;
 	}
+	cout << "peak resident memory: " << (peakResidentMemory() >> 20) << " MB (budget for the tracks " << (maxMemory >> 20) << " MB)\n";
 }
 
 
-void printFRCurve(string outputFile, int totalFeatNum, FeatureTypes type, uint64_t estimatedGenomeSize, FRC frc){
-	ofstream myfile;
-	myfile.open (outputFile.c_str());
-
-	cout << "now computing " << returnFeatureName(type) << "\t";
-	if (totalFeatNum == 0 ) {
-		myfile << "0 100\n";
-		cout << "No features of this kind: DONE\n";
-		return;
+// the instrumentation of the run (if --report)
+void writeReport(string reportFile) {
+	if(RunReport::enabled() and !RunReport::write(reportFile)) {
+		ERROR_CHANNEL << "cannot write " << reportFile << endl;
 	}
-	float step = totalFeatNum/(float)100;
-	float partial=0;
-	uint64_t edgeCoverage = 0;
+}
 
-	while(partial <= totalFeatNum) {
-		uint32_t featuresStep = 0;
-		uint32_t contigStep    = 0;
-		featuresStep += frc.getFeatures(type, contigStep);
 
-		while(featuresStep <= partial) {
-			contigStep++;
-			if(contigStep < frc.returnContigs()) {
-				featuresStep +=  frc.getFeatures(type, contigStep);
-			} else {
-				featuresStep = partial + 1; // I read all the contigs, time to to stop
+// prints the features of the regions CONTIG[:START-END] from an indexed feature file
+int queryFeatures(string featureFile, const vector<string> &regions) {
+	FeatureFileReader features;
+	if(!features.open(featureFile)) {
+		ERROR_CHANNEL << "cannot read " << featureFile << " or its index " << featureFile << FEATURE_INDEX_SUFFIX << endl;
+		return 2;
+	}
+	vector<featureRecord> found;
+	for(unsigned int i = 0; i < regions.size(); i++) {
+		string contig = regions[i];
+		uint32_t start = 0;
+		uint32_t end   = 0;
+		size_t colon   = contig.rfind(':');
+		bool range     = false;
+		if(colon != string::npos) { // a range, unless the contig name has colons
+			unsigned int from, to;
+			char dash;
+			stringstream interval(contig.substr(colon + 1));
+			if(interval >> from >> dash >> to and dash == '-' and interval.eof()) {
+				start = from;
+				end   = to;
+				range = true;
+				contig.erase(colon);
 			}
 		}
-
-		edgeCoverage = 0;
-		for(unsigned int i=0; i< contigStep; i++) {
-			edgeCoverage += frc.getContigLength(i);
+		unsigned int ctg;
+		if(!features.contigId(contig, ctg)) {
+			ERROR_CHANNEL << "unknown contig " << contig << " in region " << regions[i] << endl;
+			return 2;
+		}
+		if(!range) {
+			end = features.contigLength(ctg) + 1;
+		}
+		if(!features.query(ctg, start, end, found)) {
+			return 2;
+		}
+		for(unsigned int j = 0; j < found.size(); j++) {
+			cout << contig << " " << returnFeatureName((FeatureTypes)found[j].feature) << " " << found[j].start << " " << found[j].end << "\n";
 		}
-		float coveragePartial =  100*(edgeCoverage/(float)estimatedGenomeSize);
-		myfile << partial << " " << coveragePartial << "\n";
-		partial += step;
+	}
+	return 0;
+}
 
 
-		if(partial >= totalFeatNum) {
-			partial = totalFeatNum + 1;
+// ranks the assemblies of previous runs from their curves, each assembly is named after its output header (the file name without suffix)
+int rankAssemblies(const vector<string> &FRCurvesFiles, string rankingFile) {
+	vector<string> assemblies;
+	vector<vector<FRCurve> > curves(FRCurvesFiles.size());
+	for(unsigned int i = 0; i < FRCurvesFiles.size(); i++) {
+		if(!readFRCurves(FRCurvesFiles[i], curves[i])) {
+			ERROR_CHANNEL << "cannot read the FRCurves of " << FRCurvesFiles[i] << endl;
+			return 2;
 		}
-
-		if(contigStep >= frc.returnContigs()) {
-			partial = totalFeatNum + 1;
+		string name = FRCurvesFiles[i];
+		string suffix = FRCURVES_SUFFIX;
+		if(name.size() > suffix.size() and name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+			name.erase(name.size() - suffix.size());
 		}
+		assemblies.push_back(name);
+	}
+	ofstream ranking;
+	ranking.open(rankingFile.c_str());
+	printRanking(ranking, assemblies, curves);
+	printRanking(cout, assemblies, curves);
+	ranking.close();
+	return 0;
+}
+
+
+/*
+ * Library statistics of a BAM file, loaded from its cache when possible. With summaries (single pass) the contigs are
+ * built in the same read; otherwise the statistics are estimated on a sample (sampleError > 0, with an index and an assembly
+ * long enough, see samplingPays) or computed on the whole file, by reference shards when threads > 1. Statistics computed
+ * on the whole file are stored in the cache.
+ */
+LibraryStatistics libraryStatistics(string bamFileName, uint64_t estimatedGenomeSize, uint32_t max_insert, bool is_mp, unsigned int binSize, unsigned int threads,
+		unsigned int readAhead, float sampleError, bool useCache, ContigSummaries *summaries) {
+	libraryCounts counts;
+	if(summaries == NULL and useCache and loadLibraryCounts(bamFileName, max_insert, is_mp, counts)) {
+		cout << "library statistics loaded from " << bamFileName << LIBRARY_CACHE_SUFFIX << "\n";
+		LibraryStatistics library = counts.statistics(estimatedGenomeSize);
+		library.library_name = libraryName(bamFileName);
+		return library;
 	}
-	cout << "\n";
-	myfile.close();
 
+	LibraryStatistics library;
+	if(sampleError > 0 and summaries == NULL and !hasBamIndex(bamFileName)) {
+		cout << "no index found for " << bamFileName << ", all the alignments are used\n";
+		sampleError = 0;
+	}
+	if(sampleError > 0 and summaries == NULL and !samplingPays(bamFileName)) {
+		cout << "the assembly of " << bamFileName << " is too short to sample, all the alignments are used\n";
+		sampleError = 0;
+	}
+	if(summaries != NULL) {
+		library = computeLibraryStatsSinglePass(bamFileName, estimatedGenomeSize, max_insert, is_mp, binSize, readAhead, *summaries, &counts);
+	} else if(sampleError > 0) {
+		return sampleLibraryStats(bamFileName, estimatedGenomeSize, max_insert, is_mp, sampleError, readAhead); // never cached
+	} else if(threads > 1 and hasBamIndex(bamFileName)) {
+		library = computeShardedLibraryStats(bamFileName, estimatedGenomeSize, max_insert, is_mp, threads, readAhead, &counts);
+	} else {
+		library = computeLibraryStats(bamFileName, estimatedGenomeSize, max_insert, is_mp, readAhead, &counts);
+	}
+	if(useCache and !storeLibraryCounts(bamFileName, max_insert, is_mp, counts)) {
+		cout << "cannot store the library statistics in " << bamFileName << LIBRARY_CACHE_SUFFIX << "\n";
+	}
+	return library;
 }
 
 
 
 
-void computeFRC(FRC & frc, string bamFileName, LibraryStatistics library,int max_insert, bool is_mp, float CE_min, float CE_max) {
+void computeFRC(FRC & frc, string bamFileName, LibraryStatistics library,int max_insert, bool is_mp, float CE_min, float CE_max, unsigned int binSize, unsigned int threads, unsigned int readAhead, string tablePrefix, ContigSummaries *summaries) {
 	frc.setC_A(library.C_A);
 	frc.setS_A(library.S_A);
 	frc.setC_D(library.C_D);
@@ -508,7 +849,8 @@ void computeFRC(FRC & frc, string bamFileName, LibraryStatistics library,int max
 
 	unsigned int windowStepCE = library.insertMean;
 
-	BamReader bamFile;
+	AlignmentReader bamFile;
+	bamFile.SetReadAhead(readAhead);
 	bamFile.Open(bamFileName);
 	SamHeader head = bamFile.GetHeader(); // get the sam header
 	SamSequenceDictionary sequences  = head.Sequences;
@@ -523,93 +865,89 @@ void computeFRC(FRC & frc, string bamFileName, LibraryStatistics library,int max
 
 	}
 
-	BamAlignment al;
+	alignmentCore al;
 	int currentContig 	= -1;
 	uint32_t contigSize = 0;
 	Contig *contig;
+	unsigned int tracks = is_mp ? MP_TRACKS : PE_TRACKS; // per base tracks needed by the features computed on this library
 
 	// open file descriptor to store contig stats
-	ofstream ContigMetricsFile; // This file descriptor will contain statistics for the all assembly
-	string   ContigMetricsFileName = library.library_name + "_contigsTable.csv";
-	ContigMetricsFile.open(ContigMetricsFileName.c_str());
+	TextWriter ContigMetricsFile; // This file descriptor will contain statistics for the all assembly
+	string   ContigMetricsFileName = tablePrefix + library.library_name + "_contigsTable.csv";
+	ContigMetricsFile.open(ContigMetricsFileName, true); // written while features are computed
 	print_contigMetricsFileHeader(ContigMetricsFile);
 
+	PhaseClock clock;
+	if(summaries != NULL) { // contigs were built while computing the library statistics
+		bamFile.Close();
+		Contig contig("", 0, tracks, binSize);
+		unsigned int ctg;
+		summaries->rewind();
+		clock.restart();
+		while(summaries->next(ctg, contig)) {
+			clock.lap(PHASE_TRACKS);
+			contig.printContigMetrics(ContigMetricsFile);
+			frc.computeFeatures(is_mp ? "MP" : "PE", ctg, &contig, 1000, 200, CE_min, CE_max, library.insertMean, windowStepCE);
+			clock.lap(PHASE_FEATURES);
+		}
+		return;
+	}
+	if(threads > 1 and hasBamIndex(bamFileName)) { // every thread reads its own references
+		bamFile.Close();
+		if(!computeShardedFRC(frc, bamFileName, is_mp, max_insert, CE_min, CE_max, windowStepCE, binSize, ContigMetricsFile, threads, readAhead)) {
+			exit(2);
+		}
+		return;
+	}
+	if(threads > 1) {
+		ContigPipeline pipeline(frc, library.library_name, is_mp, max_insert, CE_min, CE_max, windowStepCE, binSize, position2contig, ContigMetricsFile, threads);
+		pipeline.run(bamFile);
+		bamFile.Close();
+		return;
+	}
+
+	clock.restart();
 	while ( bamFile.GetNextAlignmentCore(al) ) {
+		clock.lap(PHASE_DECODE);
 		if (al.IsMapped()) {
 			if (al.RefID != currentContig) { // another contig or simply the first one
 				//cout << "now porcessing contig " << contig << "\n";
 				if(currentContig == -1) { // first read that I`m processing
 					contigSize 		= frc.getContigLength(al.RefID) ;
 					currentContig 	= al.RefID;
-					contig =  new Contig(position2contig[currentContig], contigSize);
+					contig =  new Contig(position2contig[currentContig], contigSize, tracks, binSize);
 				} else {
+					contig->finalize();
 					float coverage = frc.obtainCoverage(currentContig, contig);
 					contig->printContigMetrics(ContigMetricsFile);
 
-					frc.computeCEstats(contig, library.insertMean, windowStepCE, library.insertMean, library.insertStd);
-					//frc.computeCEstats(contig, 1000, 200, library.insertMean, library.insertStd);
-					if(is_mp) {
-						//frc.computeLowCoverageArea("MP", currentContig, contig, 1000, 200);
-						//frc.computeHighCoverageArea("MP", currentContig, contig, 1000, 200);
-						//frc.computeLowNormalArea("MP", currentContig, contig, 1000, 200);
-						//frc.computeHighNormalArea("MP", currentContig, contig, 1000, 200);
-						frc.computeHighSingleArea("MP", currentContig, contig, 1000, 200);
-						frc.computeHighOutieArea("MP", currentContig, contig, 1000, 200);
-						frc.computeHighSpanningArea("MP", currentContig, contig, 1000, 200);
-						frc.computeCompressionArea("MP", currentContig, contig, CE_min, library.insertMean, library.insertMean);
-						frc.computeStrechArea("MP", currentContig, contig, CE_max, library.insertMean, library.insertMean);
-					} else {
-						frc.computeLowCoverageArea("PE", currentContig, contig, 1000, 200);
-						frc.computeHighCoverageArea("PE", currentContig, contig, 1000, 200);
-						frc.computeLowNormalArea("PE", currentContig, contig, 1000, 200);
-						frc.computeHighNormalArea("PE", currentContig, contig, 1000, 200);
-						frc.computeHighSingleArea("PE", currentContig, contig, 1000, 200);
-						frc.computeHighOutieArea("PE", currentContig, contig, 1000, 200);
-						frc.computeHighSpanningArea("PE", currentContig, contig, 1000, 200);
-						frc.computeCompressionArea("PE", currentContig, contig, CE_min, library.insertMean, library.insertMean);
-						frc.computeStrechArea("PE", currentContig, contig, CE_max, library.insertMean, library.insertMean);
-					}
+					frc.computeFeatures(is_mp ? "MP" : "PE", currentContig, contig, 1000, 200, CE_min, CE_max, library.insertMean, windowStepCE);
+					clock.lap(PHASE_FEATURES);
+					clock.contigDone(library.library_name, position2contig[currentContig], contigSize);
 
-					delete contig; // delete hold contig
 					contigSize = frc.getContigLength(al.RefID) ;
 					if (contigSize < 1) {//We can't have such sizes! this can't be right
 						fprintf(stderr,"%d has size %d, which can't be right!\nCheck bam header!",al.RefID,contigSize);
 					}
 					currentContig 	= al.RefID; // update current identifier
-					contig 			= new Contig(position2contig[currentContig], contigSize);
+					contig->reset(position2contig[currentContig], contigSize, tracks, binSize); // reuse the memory of the old contig
 				}
+				clock.contigStart();
 				contig->updateContig(al, max_insert, is_mp); // update contig with alignment
 			} else {
 				//add information to current contig
 				contig->updateContig(al, max_insert, is_mp);
 			}
+			clock.lap(PHASE_TRACKS);
 		}
 	}
 	//Last contig needs to be processed (I finished o read the file without parsing it)
+	contig->finalize();
 	float coverage = frc.obtainCoverage(currentContig, contig);
 	contig->printContigMetrics(ContigMetricsFile);
-	frc.computeCEstats(contig, library.insertMean, windowStepCE, library.insertMean, library.insertStd);
-	if(is_mp) {
-		//frc.computeLowCoverageArea("MP", currentContig, contig, 1000, 200);
-		//frc.computeHighCoverageArea("MP", currentContig, contig, 1000, 200);
-		//frc.computeLowNormalArea("MP", currentContig, contig, 1000, 200);
-		//frc.computeHighNormalArea("MP", currentContig, contig, 1000, 200);
-		frc.computeHighSingleArea("MP", currentContig, contig, 1000, 200);
-		frc.computeHighOutieArea("MP", currentContig, contig, 1000, 200);
-		frc.computeHighSpanningArea("MP", currentContig, contig, 1000, 200);
-		frc.computeCompressionArea("MP", currentContig, contig, CE_min, library.insertMean, library.insertMean);
-		frc.computeStrechArea("MP", currentContig, contig, CE_max, library.insertMean, library.insertMean);
-	} else {
-		frc.computeLowCoverageArea("PE", currentContig, contig, 1000, 200);
-		frc.computeHighCoverageArea("PE", currentContig, contig, 1000, 200);
-		frc.computeLowNormalArea("PE", currentContig, contig, 1000, 200);
-		frc.computeHighNormalArea("PE", currentContig, contig, 1000, 200);
-		frc.computeHighSingleArea("PE", currentContig, contig, 1000, 200);
-		frc.computeHighOutieArea("PE", currentContig, contig, 1000, 200);
-		frc.computeHighSpanningArea("PE", currentContig, contig, 1000, 200);
-		frc.computeCompressionArea("PE", currentContig, contig, CE_min, library.insertMean, library.insertMean);
-		frc.computeStrechArea("PE", currentContig, contig, CE_max, library.insertMean, library.insertMean);
-	}
+	frc.computeFeatures(is_mp ? "MP" : "PE", currentContig, contig, 1000, 200, CE_min, CE_max, library.insertMean, windowStepCE);
+	clock.lap(PHASE_FEATURES);
+	clock.contigDone(library.library_name, position2contig[currentContig], contigSize);
 
 
 	delete contig; // delete hold contig
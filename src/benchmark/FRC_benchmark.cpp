@@ -0,0 +1,594 @@
+/*
+ * Times the FRC engine on synthetic assemblies (see SyntheticAssembly): the single steps on one thread (micro) and
+ * whole FRC runs with several threads (macro), which must all write the same outputs. Results go to stdout, one tab
+ * separated line per measurement: benchmark scale library threads items seconds ns_per_item, the best of --repeat runs.
+ * Everything else goes to stderr.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include "common.h"
+#include "data_structures/Contig.h"
+#include "data_structures/FRC.h"
+#include "data_structures/FRCurveBuilder.h"
+#include "data_structures/LibrarySampling.h"
+#include "data_structures/RunReport.h"
+#include "benchmark/SyntheticAssembly.h"
+
+namespace po = boost::program_options;
+
+
+#define PE_MAX_INSERT 5000 // the defaults of FRC
+#define MP_MAX_INSERT 20000
+
+#define SAMPLING_CHECK_SLACK 1e-3 // relative, see checkSampling
+#define SAMPLING_CHECK_WIDTH 2    // times the 95% interval
+
+
+struct benchmarkScale {
+	string name;
+	syntheticSettings assembly;
+	syntheticLibrary PE;
+	syntheticLibrary MP;
+};
+
+// one line of the results
+struct measure {
+	string benchmark;
+	string library;
+	unsigned int threads;
+	uint64_t items;
+	double seconds;
+};
+
+
+static vector<benchmarkScale> scales() {
+	vector<benchmarkScale> all;
+	const char *names[4]          = {"tiny", "small", "medium", "large"};
+	unsigned int contigs[4]       = {100, 1000, 5000, 100};
+	uint32_t minLength[4]         = {1000, 1000, 1000, 100000};
+	uint32_t maxLength[4]         = {20000, 50000, 100000, 2000000};
+	for(unsigned int i = 0; i < 4; i++) {
+		benchmarkScale scale;
+		scale.name = names[i];
+		scale.assembly.contigs   = contigs[i];
+		scale.assembly.minLength = minLength[i];
+		scale.assembly.maxLength = maxLength[i];
+		scale.PE = syntheticLibrary(false);
+		scale.MP = syntheticLibrary(true);
+		all.push_back(scale);
+	}
+	return all;
+}
+
+
+// every setting the BAM files of a scale depend on: they are generated again when it changes
+static string describe(const benchmarkScale &scale) {
+	stringstream text;
+	const syntheticSettings &a = scale.assembly;
+	text << "contigs " << a.contigs << " lengths " << a.minLength << "-" << a.maxLength << " " << (a.distribution == UNIFORM_LENGTHS ? "uniform" : "log-uniform")
+			<< " seed " << a.seed << " collapses " << a.collapses << " expansions " << a.expansions << " inversions " << a.inversions
+			<< " misassembly-length " << a.misassemblyLength << "\n";
+	const syntheticLibrary *libraries[2] = {&scale.PE, &scale.MP};
+	for(unsigned int i = 0; i < 2; i++) {
+		const syntheticLibrary &l = *libraries[i];
+		text << (l.is_mp ? "MP" : "PE") << " coverage " << l.coverage << " read-length " << l.readLength << " insert " << l.insertMean << " +/- " << l.insertStd
+				<< " singletons " << l.singletons << " misoriented " << l.misoriented << " chimeric " << l.chimeric << " seed " << l.seed << "\n";
+	}
+	return text.str();
+}
+
+
+static void generate(const benchmarkScale &scale, string directory) {
+	string stampFileName = directory + "/" + scale.name + ".settings";
+	string settings = describe(scale);
+	ifstream stampFile(stampFileName.c_str());
+	stringstream stamp;
+	stamp << stampFile.rdbuf();
+	if(stamp.str() == settings and boost::filesystem::exists(directory + "/" + scale.name + "_pe.bam") and
+			boost::filesystem::exists(directory + "/" + scale.name + "_mp.bam")) {
+		cerr << scale.name << ": BAM files already generated\n";
+		return;
+	}
+
+	SyntheticAssembly assembly(scale.assembly);
+	const vector<misassembly> &misassemblies = assembly.getMisassemblies();
+	unsigned int events[3] = {0, 0, 0};
+	for(unsigned int i = 0; i < misassemblies.size(); i++) {
+		events[misassemblies[i].type]++;
+	}
+	cerr << scale.name << ": " << scale.assembly.contigs << " contigs, " << assembly.getLength() << " bases, " << events[COLLAPSE] << " collapses, "
+			<< events[EXPANSION] << " expansions, " << events[INVERSION] << " inversions\n";
+	double start = RunReport::now();
+	uint64_t PEreads = assembly.writeLibrary(directory + "/" + scale.name + "_pe.bam", scale.PE);
+	uint64_t MPreads = assembly.writeLibrary(directory + "/" + scale.name + "_mp.bam", scale.MP);
+	if(PEreads == 0 or MPreads == 0) {
+		exit(2);
+	}
+	cerr << scale.name << ": " << PEreads << " PE and " << MPreads << " MP alignments written in " << RunReport::now() - start << " seconds\n";
+
+	// where the features should be found
+	ofstream truth((directory + "/" + scale.name + "_misassemblies.txt").c_str());
+	const char *typeNames[3] = {"COLLAPSE", "EXPANSION", "INVERSION"};
+	const RefVector &references = assembly.getReferences();
+	for(unsigned int i = 0; i < misassemblies.size(); i++) {
+		const misassembly &event = misassemblies[i];
+		truth << references[event.contig].RefName << " " << event.start << " " << event.start + event.length << " " << typeNames[event.type] << "\n";
+	}
+
+	ofstream newStamp(stampFileName.c_str());
+	newStamp << settings;
+}
+
+
+static void add(vector<measure> &measures, string benchmark, string library, unsigned int threads, uint64_t items, double seconds) {
+	for(unsigned int i = 0; i < measures.size(); i++) {
+		if(measures[i].benchmark == benchmark and measures[i].library == library and measures[i].threads == threads) {
+			measures[i].items   += items;
+			measures[i].seconds += seconds;
+			return;
+		}
+	}
+	measure m;
+	m.benchmark = benchmark;
+	m.library   = library;
+	m.threads   = threads;
+	m.items     = items;
+	m.seconds   = seconds;
+	measures.push_back(m);
+}
+
+
+// the single steps of one library, contig by contig, the features are stored in frc
+static void microLibrary(string bamFileName, bool is_mp, uint64_t genomeLength, FRC &frc, vector<measure> &measures) {
+	string type = is_mp ? "MP" : "PE";
+	uint32_t max_insert = is_mp ? MP_MAX_INSERT : PE_MAX_INSERT;
+	float CE_min = is_mp ? -7 : -5;
+	float CE_max = is_mp ? 7 : 5;
+
+	double start = RunReport::now();
+	LibraryStatistics library = computeLibraryStats(bamFileName, genomeLength, max_insert, is_mp);
+	add(measures, "library_statistics", type, 1, library.reads, RunReport::now() - start);
+	frc.setC_A(library.C_A);
+	frc.setS_A(library.S_A);
+	frc.setC_D(library.C_D);
+	frc.setC_M(library.C_M);
+	frc.setC_S(library.C_S);
+	frc.setC_W(library.C_W);
+	frc.setInsertMean(library.insertMean);
+	frc.setInsertStd(library.insertStd);
+	unsigned int CEwindow = library.insertMean;
+
+	AlignmentReader bamFile;
+	bamFile.Open(bamFileName);
+	Contig contig("", 0, is_mp ? MP_TRACKS : PE_TRACKS);
+	vector<alignmentCore> alignments; // of the contig, decoded before the tracks are timed
+	alignmentCore al;
+	bool more = true;
+	double decode = 0;
+	uint64_t decoded = 0;
+	start = RunReport::now();
+	more = bamFile.GetNextAlignmentCore(al);
+	decode += RunReport::now() - start;
+	while(more) {
+		int32_t ctg = al.RefID;
+		alignments.clear();
+		start = RunReport::now();
+		while(more and al.RefID == ctg) {
+			if(al.IsMapped()) {
+				alignments.push_back(al);
+			}
+			decoded++;
+			more = bamFile.GetNextAlignmentCore(al);
+		}
+		decode += RunReport::now() - start;
+		if(ctg < 0 or alignments.empty()) {
+			continue;
+		}
+
+		unsigned int length = frc.getContigLength(ctg);
+		contig.reset(frc.getID(ctg), length, is_mp ? MP_TRACKS : PE_TRACKS);
+		start = RunReport::now();
+		for(unsigned int i = 0; i < alignments.size(); i++) {
+			contig.updateContig(alignments[i], max_insert, is_mp);
+		}
+		add(measures, "updateContig", type, 1, alignments.size(), RunReport::now() - start);
+		start = RunReport::now();
+		contig.finalize();
+		add(measures, "finalize", type, 1, length, RunReport::now() - start);
+
+		// the window detectors one by one, as the FRC computes them
+		if(!is_mp) {
+			start = RunReport::now();
+			contig.getLowCoverageAreas(library.C_A, 1000, 200);
+			add(measures, "lowCoverageAreas", type, 1, length, RunReport::now() - start);
+			start = RunReport::now();
+			contig.getHighCoverageAreas(library.C_A, 1000, 200);
+			add(measures, "highCoverageAreas", type, 1, length, RunReport::now() - start);
+			start = RunReport::now();
+			contig.getLowNormalAreas(library.C_M, 1000, 200);
+			add(measures, "lowNormalAreas", type, 1, length, RunReport::now() - start);
+			start = RunReport::now();
+			contig.getHighNormalAreas(library.C_M, 1000, 200);
+			add(measures, "highNormalAreas", type, 1, length, RunReport::now() - start);
+		}
+		start = RunReport::now();
+		contig.getHighSingleAreas(1000, 200, library.C_A);
+		add(measures, "highSingleAreas", type, 1, length, RunReport::now() - start);
+		start = RunReport::now();
+		contig.getHighSpanningAreas(1000, 200, library.C_A);
+		add(measures, "highSpanningAreas", type, 1, length, RunReport::now() - start);
+		start = RunReport::now();
+		contig.getHighOutieAreas(1000, 200, library.C_A);
+		add(measures, "highOutieAreas", type, 1, length, RunReport::now() - start);
+		start = RunReport::now();
+		contig.getCompressionAreas(library.insertMean, library.insertStd, CE_min, CEwindow, CEwindow);
+		add(measures, "compressionAreas", type, 1, length, RunReport::now() - start);
+		start = RunReport::now();
+		contig.getExpansionAreas(library.insertMean, library.insertStd, CE_max, CEwindow, CEwindow);
+		add(measures, "expansionAreas", type, 1, length, RunReport::now() - start);
+
+		FRC CEfrc; // not to count the CE statistics twice in frc
+		start = RunReport::now();
+		CEfrc.computeCEstats(&contig, CEwindow, CEwindow, library.insertMean, library.insertStd);
+		add(measures, "computeCEstats", type, 1, length, RunReport::now() - start);
+
+		// all of them in the single sweep of a run
+		start = RunReport::now();
+		frc.computeFeatures(type, ctg, &contig, 1000, 200, CE_min, CE_max, CEwindow, CEwindow);
+		add(measures, "computeFeatures", type, 1, length, RunReport::now() - start);
+	}
+	bamFile.Close();
+	add(measures, "decode", type, 1, decoded, decode);
+}
+
+
+static vector<measure> timeSteps(string directory, const benchmarkScale &scale) {
+	vector<measure> measures;
+	string PEfile = directory + "/" + scale.name + "_pe.bam";
+	string MPfile = directory + "/" + scale.name + "_mp.bam";
+
+	AlignmentReader bamFile;
+	bamFile.Open(PEfile);
+	RefVector references = bamFile.GetReferenceData();
+	bamFile.Close();
+	uint64_t genomeLength = 0;
+	FRC PEfrc(references.size());
+	FRC MPfrc(references.size());
+	for(unsigned int i = 0; i < references.size(); i++) {
+		genomeLength += references[i].RefLength;
+		PEfrc.setID(i, references[i].RefName);
+		PEfrc.setContigLength(i, references[i].RefLength);
+		MPfrc.setID(i, references[i].RefName);
+		MPfrc.setContigLength(i, references[i].RefLength);
+	}
+	microLibrary(PEfile, false, genomeLength, PEfrc, measures);
+	microLibrary(MPfile, true, genomeLength, MPfrc, measures);
+
+	PEfrc.mergeFeatures(MPfrc);
+	double start = RunReport::now();
+	FRCurveBuilder curves(PEfrc);
+	add(measures, "FRCurveBuilder", "all", 1, curves.contigs(), RunReport::now() - start);
+	string curvesFile = directory + "/" + scale.name + "_curve.txt";
+	start = RunReport::now();
+	for(unsigned int type = FRC_TOTAL; type < FEATURE_TYPES; type++) {
+		curves.printFRCurve(curvesFile, curves.totalFeatures((FeatureTypes)type), (FeatureTypes)type, genomeLength);
+	}
+	add(measures, "printFRCurve", "all", 1, FEATURE_TYPES, RunReport::now() - start);
+	boost::filesystem::remove(curvesFile);
+	return measures;
+}
+
+
+static uint64_t countAlignments(string bamFileName) {
+	AlignmentReader bamFile;
+	bamFile.Open(bamFileName);
+	alignmentCore al;
+	uint64_t alignments = 0;
+	while(bamFile.GetNextAlignmentCore(al)) {
+		alignments++;
+	}
+	bamFile.Close();
+	return alignments;
+}
+
+
+static string fileContent(string fileName) {
+	ifstream file(fileName.c_str(), ios::binary);
+	stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+// the outputs of two runs differing, stdout.txt (with the timings) aside
+static vector<string> differentOutputs(string directory, string other) {
+	vector<string> different;
+	for(boost::filesystem::directory_iterator i(directory); i != boost::filesystem::directory_iterator(); ++i) {
+		string name = i->path().filename().string();
+		if(name == "stdout.txt" or !boost::filesystem::is_regular_file(i->status())) {
+			continue;
+		}
+		if(fileContent(i->path().string()) != fileContent(other + "/" + name)) {
+			different.push_back(name);
+		}
+	}
+	return different;
+}
+
+
+// whole runs of the FRC executable, every thread count must write the same outputs of the first one
+static vector<measure> timeRuns(string directory, const benchmarkScale &scale, string FRCbinary, const vector<unsigned int> &threads) {
+	vector<measure> measures;
+	string PEfile = boost::filesystem::absolute(directory + "/" + scale.name + "_pe.bam").string();
+	string MPfile = boost::filesystem::absolute(directory + "/" + scale.name + "_mp.bam").string();
+	FRCbinary = boost::filesystem::absolute(FRCbinary).string();
+	uint64_t alignments = countAlignments(PEfile) + countAlignments(MPfile);
+	for(unsigned int i = 0; i < threads.size(); i++) {
+		stringstream runDirectory;
+		runDirectory << directory << "/run_" << scale.name << "_" << threads[i];
+		boost::filesystem::create_directories(runDirectory.str());
+		stringstream command; // run in its directory: the contig tables are written in the working directory
+		command << "cd \"" << runDirectory.str() << "\" && \"" << FRCbinary << "\" --pe-sam \"" << PEfile << "\" --mp-sam \"" << MPfile << "\" --output run"
+				<< " --threads " << threads[i] << " --no-stats-cache > stdout.txt 2>&1";
+		double start = RunReport::now();
+		int status = system(command.str().c_str());
+		double seconds = RunReport::now() - start;
+		if(status != 0) {
+			cerr << "FRC failed (see " << runDirectory.str() << "/stdout.txt): " << command.str() << "\n";
+			exit(2);
+		}
+		add(measures, "FRC", "all", threads[i], alignments, seconds);
+
+		stringstream firstDirectory;
+		firstDirectory << directory << "/run_" << scale.name << "_" << threads[0];
+		vector<string> different = differentOutputs(firstDirectory.str(), runDirectory.str());
+		for(unsigned int j = 0; j < different.size(); j++) {
+			cerr << different[j] << " of " << runDirectory.str() << " differs from the one of " << firstDirectory.str() << "\n";
+		}
+		if(different.size() > 0) {
+			exit(2);
+		}
+	}
+	return measures;
+}
+
+
+/*
+ * Library statistics sampled with maxError (as FRC --sample-error) against the exact ones, the values out of the 95% interval
+ * reported by the sampling are marked. The misassemblies of the assembly make the insert size mean and std hard to sample.
+ * Eight 95% intervals miss now and then: the check fails only on a value out of SAMPLING_CHECK_WIDTH times its interval,
+ * as a wrong bound is.
+ */
+static bool checkSampling(string directory, const benchmarkScale &scale, float maxError, vector<measure> &measures) {
+	bool ok = true;
+	for(unsigned int l = 0; l < 2; l++) {
+		bool is_mp = l == 1;
+		string type = is_mp ? "MP" : "PE";
+		string bamFileName = directory + "/" + scale.name + (is_mp ? "_mp.bam" : "_pe.bam");
+		uint32_t max_insert = is_mp ? MP_MAX_INSERT : PE_MAX_INSERT;
+		AlignmentReader bamFile;
+		bamFile.Open(bamFileName);
+		RefVector references = bamFile.GetReferenceData();
+		bamFile.Close();
+		uint64_t genomeLength = 0;
+		for(unsigned int i = 0; i < references.size(); i++) {
+			genomeLength += references[i].RefLength;
+		}
+
+		double start = RunReport::now();
+		LibraryStatistics exact = computeLibraryStats(bamFileName, genomeLength, max_insert, is_mp);
+		add(measures, "library_statistics", type, 1, exact.reads, RunReport::now() - start);
+		start = RunReport::now();
+		LibraryStatistics sampled = sampleLibraryStats(bamFileName, genomeLength, max_insert, is_mp, maxError);
+		add(measures, "library_sampling", type, 1, sampled.sampledFraction * exact.reads, RunReport::now() - start);
+
+		const char *names[4] = {"insert_mean", "insert_std", "C_A", "C_M"};
+		float exactValues[4]   = {exact.insertMean, exact.insertStd, exact.C_A, exact.C_M};
+		float sampledValues[4] = {sampled.insertMean, sampled.insertStd, sampled.C_A, sampled.C_M};
+		float bounds[4]        = {sampled.insertMeanError, sampled.insertStdError, sampled.C_A_error, sampled.C_M_error};
+		for(unsigned int i = 0; i < 4; i++) {
+			// the exact pass keeps a float running mean, and the region queries can miss a read: a little slack
+			double distance = fabs(sampledValues[i] - exactValues[i]) - SAMPLING_CHECK_SLACK * fabs(exactValues[i]);
+			bool inside = distance <= bounds[i];
+			bool wrong  = distance > SAMPLING_CHECK_WIDTH * bounds[i];
+			cerr << scale.name << " " << type << " " << names[i] << ": exact " << exactValues[i] << ", sampled " << sampledValues[i] << " +/- " << bounds[i]
+					<< " on " << sampled.sampledFraction * 100 << "% of the assembly" << (inside ? "" : wrong ? ", WRONG BOUND" : ", out of the interval") << "\n";
+			ok = ok and !wrong;
+		}
+	}
+	return ok;
+}
+
+
+// the best of the repeated measures
+static void keepBest(vector<measure> &best, const vector<measure> &measures) {
+	for(unsigned int i = 0; i < measures.size(); i++) {
+		unsigned int j = 0;
+		while(j < best.size() and !(best[j].benchmark == measures[i].benchmark and best[j].library == measures[i].library and best[j].threads == measures[i].threads)) {
+			j++;
+		}
+		if(j == best.size()) {
+			best.push_back(measures[i]);
+		} else if(measures[i].seconds < best[j].seconds) {
+			best[j] = measures[i];
+		}
+	}
+}
+
+
+static void print(string scale, const vector<measure> &measures) {
+	for(unsigned int i = 0; i < measures.size(); i++) {
+		const measure &m = measures[i];
+		printf("%s\t%s\t%s\t%u\t%llu\t%.6f\t%.2f\n", m.benchmark.c_str(), scale.c_str(), m.library.c_str(), m.threads, (unsigned long long)m.items,
+				m.seconds, m.items > 0 ? m.seconds * 1e9 / m.items : 0);
+	}
+	fflush(stdout);
+}
+
+
+
+int main(int argc, char *argv[]) {
+	vector<benchmarkScale> allScales = scales();
+	stringstream scaleNames;
+	for(unsigned int i = 0; i < allScales.size(); i++) {
+		scaleNames << (i > 0 ? ", " : "") << allScales[i].name << " (" << allScales[i].assembly.contigs << " contigs of "
+				<< allScales[i].assembly.minLength << "-" << allScales[i].assembly.maxLength << " bp)";
+	}
+
+	po::options_description desc("Times the FRC engine on synthetic assemblies\n\nAllowed options");
+	desc.add_options() ("help", "produce help message")
+	("output"            , po::value<string>(), "directory of the generated BAM files (with SCALE_misassemblies.txt, the misassemblies injected as contig start end type) and of the runs (default FRC_benchmark), the BAM files are generated again only if their settings change")
+	("scale"             , po::value<vector<string> >()->composing(), ("scale to run (can be repeated, default tiny and small): " + scaleNames.str()).c_str())
+	("threads"           , po::value<vector<unsigned int> >()->multitoken(), "thread counts of the whole FRC runs, failing if their outputs differ from the ones of the first (default 1 2 4 8)")
+	("repeat"            , po::value<unsigned int>(), "runs of every benchmark, the best one is printed (default 3)")
+	("frc"               , po::value<string>(), "FRC executable (default the one next to this executable)")
+	("generate-only"     , "only generate the BAM files")
+	("micro-only"        , "only time the single steps")
+	("macro-only"        , "only time whole FRC runs")
+	("check-sampling"    , po::value<float>(), "only check the library statistics sampled with this error (as FRC --sample-error) against the exact ones, failing if an exact value is out of twice its 95% interval")
+	("contigs"           , po::value<unsigned int>(), "contigs of the assembly (overrides the scale)")
+	("min-length"        , po::value<unsigned int>(), "shortest contig (overrides the scale)")
+	("max-length"        , po::value<unsigned int>(), "longest contig (overrides the scale)")
+	("uniform-lengths"   , "contig lengths uniform between min-length and max-length (default log-uniform)")
+	("pe-coverage"       , po::value<float>(), "read coverage of the PE library (default 30)")
+	("mp-coverage"       , po::value<float>(), "read coverage of the MP library (default 10)")
+	("pe-insert"         , po::value<vector<float> >()->multitoken(), "PE insert size mean and std (default 400 40)")
+	("mp-insert"         , po::value<vector<float> >()->multitoken(), "MP insert size mean and std (default 3000 300)")
+	("read-length"       , po::value<unsigned int>(), "read length of both libraries (default 100)")
+	("collapses"         , po::value<float>(), "collapsed repeats per Mb (default 1)")
+	("expansions"        , po::value<float>(), "expansions per Mb (default 1)")
+	("inversions"        , po::value<float>(), "inversions per Mb (default 1)")
+	("misassembly-length", po::value<unsigned int>(), "longest misassembly, the shortest is half of it (default 2000)")
+	("seed"              , po::value<unsigned int>(), "seed of the assembly (the libraries have their own)")
+	;
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		po::notify(vm);
+	} catch (boost::program_options::error & error) {
+		ERROR_CHANNEL << error.what() << endl;
+		ERROR_CHANNEL << "Try \"--help\" for help" << endl;
+		exit(2);
+	}
+	if (vm.count("help")) {
+		DEFAULT_CHANNEL << desc << endl;
+		exit(0);
+	}
+
+	string directory = vm.count("output") ? vm["output"].as<string>() : "FRC_benchmark";
+	unsigned int repeat = vm.count("repeat") ? max(1u, vm["repeat"].as<unsigned int>()) : 3;
+	vector<unsigned int> threads;
+	if(vm.count("threads")) {
+		threads = vm["threads"].as<vector<unsigned int> >();
+	} else {
+		threads.push_back(1);
+		threads.push_back(2);
+		threads.push_back(4);
+		threads.push_back(8);
+	}
+	string FRCbinary = vm.count("frc") ? vm["frc"].as<string>() :
+			(boost::filesystem::path(argv[0]).parent_path() / "FRC").string();
+	if(!vm.count("generate-only") and !vm.count("micro-only") and !vm.count("check-sampling") and !boost::filesystem::exists(FRCbinary)) {
+		ERROR_CHANNEL << "cannot find the FRC executable " << FRCbinary << ", use --frc" << endl;
+		exit(2);
+	}
+
+	vector<string> names;
+	if(vm.count("scale")) {
+		names = vm["scale"].as<vector<string> >();
+	} else {
+		names.push_back("tiny");
+		names.push_back("small");
+	}
+	vector<benchmarkScale> run;
+	for(unsigned int i = 0; i < names.size(); i++) {
+		unsigned int j = 0;
+		while(j < allScales.size() and allScales[j].name != names[i]) {
+			j++;
+		}
+		if(j == allScales.size()) {
+			ERROR_CHANNEL << "unknown scale " << names[i] << endl;
+			exit(2);
+		}
+		benchmarkScale scale = allScales[j];
+		syntheticSettings &assembly = scale.assembly;
+		if(vm.count("contigs"))            assembly.contigs           = vm["contigs"].as<unsigned int>();
+		if(vm.count("min-length"))         assembly.minLength         = vm["min-length"].as<unsigned int>();
+		if(vm.count("max-length"))         assembly.maxLength         = vm["max-length"].as<unsigned int>();
+		if(vm.count("uniform-lengths"))    assembly.distribution      = UNIFORM_LENGTHS;
+		if(vm.count("collapses"))          assembly.collapses         = vm["collapses"].as<float>();
+		if(vm.count("expansions"))         assembly.expansions        = vm["expansions"].as<float>();
+		if(vm.count("inversions"))         assembly.inversions        = vm["inversions"].as<float>();
+		if(vm.count("misassembly-length")) assembly.misassemblyLength = vm["misassembly-length"].as<unsigned int>();
+		if(vm.count("seed"))               assembly.seed              = vm["seed"].as<unsigned int>();
+		if(vm.count("pe-coverage"))        scale.PE.coverage          = vm["pe-coverage"].as<float>();
+		if(vm.count("mp-coverage"))        scale.MP.coverage          = vm["mp-coverage"].as<float>();
+		if(vm.count("read-length")) {
+			scale.PE.readLength = scale.MP.readLength = vm["read-length"].as<unsigned int>();
+		}
+		const char *inserts[2] = {"pe-insert", "mp-insert"};
+		syntheticLibrary *libraries[2] = {&scale.PE, &scale.MP};
+		for(unsigned int l = 0; l < 2; l++) {
+			if(vm.count(inserts[l])) {
+				vector<float> insert = vm[inserts[l]].as<vector<float> >();
+				if(insert.size() != 2) {
+					ERROR_CHANNEL << "--" << inserts[l] << " needs the mean and the std" << endl;
+					exit(2);
+				}
+				libraries[l]->insertMean = insert[0];
+				libraries[l]->insertStd  = insert[1];
+			}
+		}
+		if(assembly.contigs == 0 or assembly.minLength == 0 or assembly.minLength > assembly.maxLength) {
+			ERROR_CHANNEL << "the contig lengths of " << scale.name << " must be positive, with min-length at most max-length" << endl;
+			exit(2);
+		}
+		run.push_back(scale);
+	}
+
+	boost::filesystem::create_directories(directory);
+	cout.rdbuf(cerr.rdbuf()); // the messages of the engine (e.g. of printFRCurve), stdout only gets the results
+	printf("benchmark\tscale\tlibrary\tthreads\titems\tseconds\tns_per_item\n");
+	bool sampled = true; // every sampled statistic within its interval
+	for(unsigned int i = 0; i < run.size(); i++) {
+		generate(run[i], directory);
+		if(vm.count("generate-only")) {
+			continue;
+		}
+		if(vm.count("check-sampling")) {
+			vector<measure> measures;
+			sampled = checkSampling(directory, run[i], vm["check-sampling"].as<float>(), measures) and sampled;
+			print(run[i].name, measures);
+			continue;
+		}
+		if(!vm.count("macro-only")) {
+			vector<measure> best;
+			for(unsigned int r = 0; r < repeat; r++) {
+				cerr << run[i].name << ": single steps, run " << r + 1 << " of " << repeat << "\n";
+				keepBest(best, timeSteps(directory, run[i]));
+			}
+			print(run[i].name, best);
+		}
+		if(!vm.count("micro-only")) {
+			vector<measure> best;
+			for(unsigned int r = 0; r < repeat; r++) {
+				cerr << run[i].name << ": FRC runs, run " << r + 1 << " of " << repeat << "\n";
+				keepBest(best, timeRuns(directory, run[i], FRCbinary, threads));
+			}
+			print(run[i].name, best);
+		}
+	}
+	if(!sampled) {
+		ERROR_CHANNEL << "sampled library statistics with wrong bounds" << endl;
+		return 2;
+	}
+	return 0;
+}
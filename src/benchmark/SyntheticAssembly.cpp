@@ -0,0 +1,291 @@
+#include "SyntheticAssembly.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <iostream>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/normal_distribution.hpp>
+
+#include "api/BamReader.h"
+#include "api/BamWriter.h"
+
+
+#define PLACEMENT_ATTEMPTS 100 // misassemblies that do not find room on the assembly are dropped
+
+
+syntheticSettings::syntheticSettings() {
+	contigs           = 1000;
+	minLength         = 1000;
+	maxLength         = 100000;
+	distribution      = LOG_UNIFORM_LENGTHS;
+	seed              = 5489u;
+	collapses         = 1;
+	expansions        = 1;
+	inversions        = 1;
+	misassemblyLength = 2000;
+}
+
+syntheticLibrary::syntheticLibrary(bool is_mp) {
+	this->is_mp = is_mp;
+	coverage    = is_mp ? 10 : 30;
+	readLength  = 100;
+	insertMean  = is_mp ? 3000 : 400;
+	insertStd   = is_mp ? 300 : 40;
+	singletons  = 0.01;
+	misoriented = 0.005;
+	chimeric    = 0.002;
+	seed        = is_mp ? 2 : 1;
+}
+
+
+struct byPosition {
+	bool operator()(const misassembly &a, const misassembly &b) const {
+		return a.contig < b.contig or (a.contig == b.contig and a.start < b.start);
+	}
+};
+
+
+SyntheticAssembly::SyntheticAssembly(const syntheticSettings &settings) {
+	this->settings = settings;
+	boost::random::mt19937 generator(settings.seed);
+	boost::random::uniform_real_distribution<double> unit(0, 1);
+
+	vector<uint64_t> starts; // of every contig on the concatenated assembly
+	uint64_t length = 0;
+	for(unsigned int i = 0; i < settings.contigs; i++) {
+		double draw = unit(generator);
+		uint32_t contigLength;
+		if(settings.distribution == LOG_UNIFORM_LENGTHS) {
+			contigLength = exp(log((double)settings.minLength) + draw * (log((double)settings.maxLength) - log((double)settings.minLength)));
+		} else {
+			contigLength = settings.minLength + draw * (settings.maxLength - settings.minLength);
+		}
+		stringstream name;
+		name << "ctg" << i;
+		references.push_back(RefData(name.str(), contigLength));
+		starts.push_back(length);
+		length += contigLength;
+	}
+
+	float rates[3] = {settings.collapses, settings.expansions, settings.inversions};
+	uint32_t pad = settings.misassemblyLength; // between two misassemblies and from the contig ends
+	for(unsigned int type = COLLAPSE; type <= INVERSION; type++) {
+		unsigned int wanted = rates[type] * length / 1000000.0 + 0.5;
+		for(unsigned int i = 0; i < wanted; i++) {
+			for(unsigned int attempt = 0; attempt < PLACEMENT_ATTEMPTS; attempt++) {
+				// contigs are picked proportionally to their length
+				uint64_t base = unit(generator) * length;
+				unsigned int ctg = upper_bound(starts.begin(), starts.end(), base) - starts.begin() - 1;
+				misassembly event;
+				event.type   = (misassemblyType)type;
+				event.contig = ctg;
+				event.length = settings.misassemblyLength / 2 + unit(generator) * (settings.misassemblyLength / 2);
+				uint32_t contigLength = references[ctg].RefLength;
+				if(contigLength < 2 * (pad + event.length)) {
+					continue;
+				}
+				event.start = pad + event.length + unit(generator) * (contigLength - 2 * (pad + event.length)); // a collapse needs its copy before it
+				bool overlaps = false;
+				for(unsigned int j = 0; j < misassemblies.size() and !overlaps; j++) {
+					const misassembly &other = misassemblies[j];
+					overlaps = other.contig == ctg and event.start < other.start + other.length + pad and other.start < event.start + event.length + pad;
+				}
+				if(!overlaps) {
+					misassemblies.push_back(event);
+					break;
+				}
+			}
+		}
+	}
+	sort(misassemblies.begin(), misassemblies.end(), byPosition());
+}
+
+
+const RefVector & SyntheticAssembly::getReferences() const {
+	return references;
+}
+
+const vector<misassembly> & SyntheticAssembly::getMisassemblies() const {
+	return misassemblies;
+}
+
+uint64_t SyntheticAssembly::getLength() const {
+	uint64_t length = 0;
+	for(unsigned int i = 0; i < references.size(); i++) {
+		length += references[i].RefLength;
+	}
+	return length;
+}
+
+
+
+// one alignment to write, sorted by position
+struct syntheticRead {
+	int32_t position;
+	int32_t mateRefID;   // -1: mate unmapped
+	int32_t matePosition;
+	int32_t insertSize;
+	uint32_t pair;
+	bool second;
+	bool reverse;
+	bool mateReverse;
+	bool unmapped;
+
+	bool operator<(const syntheticRead &other) const {
+		if(position != other.position) {
+			return position < other.position;
+		}
+		return pair < other.pair or (pair == other.pair and second < other.second);
+	}
+};
+
+
+// contig position of the read starting at genome position g (the genome the contig was assembled from), and if it is reversed there
+static int64_t toContig(int64_t g, unsigned int readLength, vector<misassembly>::const_iterator event, vector<misassembly>::const_iterator end, bool &flipped) {
+	int64_t offset = 0; // contig - genome position
+	flipped = false;
+	for(; event != end; ++event) {
+		int64_t genomeStart = event->start - offset;
+		if(g < genomeStart) {
+			break;
+		}
+		if(event->type == COLLAPSE) {
+			if(g < genomeStart + event->length) {
+				return g + offset - event->length; // on the copy before it
+			}
+			offset -= event->length;
+		} else if(event->type == EXPANSION) {
+			offset += event->length;
+		} else if(g < genomeStart + event->length) {
+			flipped = true;
+			return event->start + (genomeStart + event->length - g) - readLength;
+		}
+	}
+	return g + offset;
+}
+
+
+uint64_t SyntheticAssembly::writeLibrary(string bamFileName, const syntheticLibrary &library) const {
+	SamHeader header;
+	header.Version   = "1.4";
+	header.SortOrder = "coordinate";
+	for(unsigned int i = 0; i < references.size(); i++) {
+		header.Sequences.Add(references[i].RefName, references[i].RefLength);
+	}
+	BamWriter writer;
+	if(!writer.Open(bamFileName, header, references)) {
+		cerr << "cannot write " << bamFileName << "\n";
+		return 0;
+	}
+
+	unsigned int readLength = library.readLength;
+	BamAlignment alignment;
+	alignment.QueryBases = string(readLength, 'A');
+	alignment.Qualities  = string(readLength, 'I');
+	alignment.Length     = readLength;
+	alignment.MapQuality = 60;
+	vector<CigarOp> matched(1, CigarOp('M', readLength));
+
+	uint64_t written = 0;
+	vector<syntheticRead> reads;
+	vector<misassembly>::const_iterator events = misassemblies.begin();
+	for(unsigned int ctg = 0; ctg < references.size(); ctg++) {
+		boost::random::mt19937 generator(library.seed * 1000003u + ctg); // every contig on its own: the same contig always gets the same reads
+		boost::random::uniform_real_distribution<double> unit(0, 1);
+		boost::random::normal_distribution<double> insertDraw(library.insertMean, library.insertStd);
+
+		vector<misassembly>::const_iterator first = events;
+		int64_t contigLength = references[ctg].RefLength;
+		int64_t genomeLength = contigLength;
+		for(; events != misassemblies.end() and events->contig == ctg; ++events) {
+			genomeLength += events->type == COLLAPSE ? events->length : events->type == EXPANSION ? -(int64_t)events->length : 0;
+		}
+
+		reads.clear();
+		uint32_t pairs = genomeLength * library.coverage / (2 * readLength);
+		for(uint32_t pair = 0; pair < pairs; pair++) {
+			int64_t insert = max((int64_t)readLength, (int64_t)insertDraw(generator));
+			if(insert > genomeLength) {
+				continue;
+			}
+			int64_t start = unit(generator) * (genomeLength - insert + 1);
+			bool flipped[2];
+			int64_t position[2];
+			position[0] = toContig(start, readLength, first, events, flipped[0]);
+			position[1] = toContig(start + insert - readLength, readLength, first, events, flipped[1]);
+			syntheticRead read[2];
+			for(unsigned int m = 0; m < 2; m++) {
+				read[m].position = max((int64_t)0, min(contigLength - readLength, position[m]));
+				read[m].pair     = pair;
+				read[m].second   = m == 1;
+				read[m].reverse  = (library.is_mp ? m == 0 : m == 1) != flipped[m]; // -> <- for PE, <- -> for MP
+				read[m].unmapped = false;
+			}
+			double noise = unit(generator);
+			if(noise < library.misoriented) {
+				read[1].reverse = !read[1].reverse;
+			}
+			noise -= library.misoriented;
+			bool single   = noise >= 0 and noise < library.singletons;
+			bool chimeric = noise >= library.singletons and noise < library.singletons + library.chimeric and references.size() > 1;
+			if(single) {
+				read[1].unmapped = true; // placed with its mate, as aligners do
+				read[1].position = read[0].position;
+			}
+			for(unsigned int m = 0; m < 2; m++) {
+				syntheticRead &mate = read[1 - m];
+				read[m].mateRefID    = mate.unmapped ? -1 : ctg;
+				read[m].matePosition = mate.position;
+				read[m].mateReverse  = mate.reverse;
+				int32_t left  = min(read[0].position, read[1].position);
+				int32_t right = max(read[0].position, read[1].position) + readLength;
+				bool leftmost = read[m].position < mate.position or (read[m].position == mate.position and m == 0);
+				read[m].insertSize = single ? 0 : (leftmost ? right - left : left - right);
+			}
+			if(chimeric) { // the mate is somewhere else, only this read is written
+				read[0].mateRefID    = (ctg + 1 + (unsigned int)(unit(generator) * (references.size() - 1))) % references.size();
+				read[0].matePosition = unit(generator) * max(1, references[read[0].mateRefID].RefLength - (int32_t)readLength);
+				read[0].insertSize   = 0;
+				reads.push_back(read[0]);
+				continue;
+			}
+			reads.push_back(read[0]);
+			reads.push_back(read[1]);
+		}
+		sort(reads.begin(), reads.end());
+
+		for(unsigned int i = 0; i < reads.size(); i++) {
+			const syntheticRead &read = reads[i];
+			stringstream name;
+			name << references[ctg].RefName << "." << read.pair;
+			alignment.Name         = name.str();
+			alignment.RefID        = ctg;
+			alignment.Position     = read.position;
+			alignment.MateRefID    = read.mateRefID == -1 ? ctg : read.mateRefID;
+			alignment.MatePosition = read.matePosition;
+			alignment.InsertSize   = read.insertSize;
+			alignment.AlignmentFlag = 0;
+			alignment.CigarData    = read.unmapped ? vector<CigarOp>() : matched;
+			alignment.SetIsPaired(true);
+			alignment.SetIsFirstMate(!read.second);
+			alignment.SetIsSecondMate(read.second);
+			alignment.SetIsMapped(!read.unmapped);
+			alignment.SetIsMateMapped(read.mateRefID != -1);
+			alignment.SetIsReverseStrand(read.reverse);
+			alignment.SetIsMateReverseStrand(read.mateReverse);
+			alignment.SetIsProperPair(read.mateRefID == (int32_t)ctg and !read.unmapped);
+			writer.SaveAlignment(alignment);
+		}
+		written += reads.size();
+	}
+	writer.Close();
+
+	BamReader reader;
+	if(!reader.Open(bamFileName) or !reader.CreateIndex()) {
+		cerr << "cannot index " << bamFileName << "\n";
+	}
+	reader.Close();
+	return written;
+}
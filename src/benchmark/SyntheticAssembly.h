@@ -0,0 +1,80 @@
+#ifndef SYNTHETICASSEMBLY_H_
+#define SYNTHETICASSEMBLY_H_
+
+#include <string>
+#include <vector>
+
+#include "api/BamAux.h"
+
+using namespace std;
+using namespace BamTools;
+
+
+enum lengthDistribution {UNIFORM_LENGTHS, LOG_UNIFORM_LENGTHS}; // log uniform: many short contigs, most bases on few long ones
+
+
+/*
+ * An assembly made up for benchmarks: contig names and lengths only, the sequence is never needed.
+ * Misassemblies are injected as the difference between the genome the pairs come from and the contigs:
+ * - collapse: length bases of the genome are missing from the contig (a repeat collapsed), the pairs across it are shorter
+ * - expansion: length bases of the contig are not in the genome, no read comes from them and the pairs across are longer
+ * - inversion: length bases of the contig are reversed, the pairs with one read inside have both reads on the same strand
+ */
+enum misassemblyType {COLLAPSE, EXPANSION, INVERSION};
+
+struct misassembly {
+	misassemblyType type;
+	unsigned int contig;
+	uint32_t start;  // on the contig
+	uint32_t length;
+};
+
+struct syntheticSettings {
+	unsigned int contigs;
+	uint32_t minLength;
+	uint32_t maxLength;
+	lengthDistribution distribution;
+	unsigned int seed;
+
+	// misassemblies per Mb of assembly, the length of each one is drawn between misassemblyLength/2 and misassemblyLength
+	float collapses;
+	float expansions;
+	float inversions;
+	uint32_t misassemblyLength;
+
+	syntheticSettings();
+};
+
+struct syntheticLibrary {
+	bool is_mp;           // <- -> pairs, -> <- otherwise
+	float coverage;       // read coverage
+	unsigned int readLength;
+	float insertMean;
+	float insertStd;
+	float singletons;     // fraction of the pairs with the mate unmapped
+	float misoriented;    // fraction of the pairs with a read on the wrong strand
+	float chimeric;       // fraction of the pairs with the mate on another contig
+	unsigned int seed;
+
+	syntheticLibrary(bool is_mp = false);
+};
+
+
+class SyntheticAssembly {
+	syntheticSettings settings;
+	RefVector references;
+	vector<misassembly> misassemblies; // sorted by contig and start
+
+public:
+	SyntheticAssembly(const syntheticSettings &settings);
+
+	const RefVector & getReferences() const;
+	const vector<misassembly> & getMisassemblies() const;
+	uint64_t getLength() const;
+
+	// a coordinate sorted and indexed BAM file of the library aligned to the assembly, returns the alignments written
+	uint64_t writeLibrary(string bamFileName, const syntheticLibrary &library) const;
+};
+
+
+#endif /* SYNTHETICASSEMBLY_H_ */
@@ -9,13 +9,18 @@
 #include <climits>
 #include <cstdlib>
 #include <sstream>
+#include <sys/resource.h>
 
 #include "api/BamAux.h"
 #include "api/BamReader.h"
 #include "api/BamAlignment.h"
+#include "api/BamConstants.h"
 
 #include <boost/filesystem.hpp>
 
+#include "data_structures/TextWriter.h"
+#include "data_structures/AlignmentReader.h"
+
 
 #ifdef INLINE_DISABLED
 #define INLINE
@@ -125,6 +130,15 @@ static int StringToNumber ( string Text ) {
 	return ss >> result ? result : 0;
 }
 
+// largest resident set of the process so far, in bytes
+static uint64_t peakResidentMemory() {
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return (uint64_t)usage.ru_maxrss * 1024; // kilobytes on Linux
+}
+
 
 struct LibraryStatistics{
 	uint32_t reads;
@@ -146,6 +160,14 @@ struct LibraryStatistics{
 	float insertMean;
 	float insertStd;
 	string library_name;
+
+	// set when the statistics are estimated on a sample of the file: 95% confidence half widths
+	bool sampled;
+	float sampledFraction; // fraction of the assembly read
+	float insertMeanError;
+	float insertStdError;
+	float C_A_error;
+	float C_M_error;
 };
 
 
@@ -153,7 +175,7 @@ struct LibraryStatistics{
 
 
 
-static readStatus computeReadType(BamAlignment al, uint32_t max_insert, bool is_mp) {
+static readStatus computeReadType(const alignmentCore &al, uint32_t max_insert, bool is_mp) {
 	if (!al.IsMapped()) {
 		return unmapped;
 	}
@@ -208,56 +230,41 @@ static readStatus computeReadType(BamAlignment al, uint32_t max_insert, bool is_
 
 
 
-static LibraryStatistics computeLibraryStats(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp) {
-	BamReader bamFile;
-	bamFile.Open(bamFileName);
-	LibraryStatistics library;
-	string library_name = boost::filesystem::path(bamFileName).stem().string();
-	library.library_name = library_name;
-
-	//All var declarations
-	uint32_t reads 		 	  = 0;
-	uint32_t unmappedReads 	  = 0;
-	uint32_t lowQualityReads  = 0;
-	uint32_t mappedReads 	  = 0;
-	uint64_t mappedReadsLength= 0;
-
-	uint64_t insertsLength = 0; // total inserts length
-	float insertMean;
-	float insertStd;
+/*
+ * Per read accounting of computeLibraryStats. Counts and lengths can be merged across parts of the same file;
+ * the insert size mean and std are computed from the exact sums, so every way of reading the file gives the same ones.
+ */
+struct libraryCounts {
+	uint32_t reads;
+	uint32_t unmappedReads;
+	uint32_t lowQualityReads;
+	uint32_t mappedReads;
+	uint64_t mappedReadsLength;
+
+	uint64_t insertsLength; // total inserts length
+	uint64_t insertsSquares; // sum of the squared inserts length
+	uint32_t inserts;
 	// mated reads (not necessary correctly mated)
-	uint32_t matedReads 	  = 0;        // reads that align on a contig with the mate
-	uint64_t matedReadsLength = 0;  // total length of mated reads
+	uint32_t matedReads;        // reads that align on a contig with the mate
+	uint64_t matedReadsLength;  // total length of mated reads
 	// wrongly distance
-	uint32_t wrongDistanceReads 		= 0;  // number of paired reads too far away
-	uint64_t wrongDistanceReadsLength   = 0; // length  of paired reads too far away
+	uint32_t wrongDistanceReads;  // number of paired reads too far away
+	uint64_t wrongDistanceReadsLength; // length  of paired reads too far away
 	// wrongly oriented reads
-	uint32_t wronglyOrientedReads 		= 0;       // number of wrongly oriented reads
-	uint64_t wronglyOrientedReadsLength = 0; // length of wrongly oriented reads
+	uint32_t wronglyOrientedReads;       // number of wrongly oriented reads
+	uint64_t wronglyOrientedReadsLength; // length of wrongly oriented reads
 	// singletons
-	uint32_t singletonReads 	  = 0; // number of singleton reads
-	uint64_t singletonReadsLength = 0;     // total length of singleton reads
+	uint32_t singletonReads; // number of singleton reads
+	uint64_t singletonReadsLength;     // total length of singleton reads
 	// mates on different contigs
-	uint32_t matedDifferentContig 		= 0; // number of contig placed in a different contig
-	uint64_t matedDifferentContigLength = 0; // total number of reads placed in different contigs
-
-	float C_A = 0; // total read coverage
-	float S_A = 0; // total span coverage
-	float C_M = 0; // coverage induced by proper pairs (same contig and correct orientation)
-	float C_W = 0; // coverage induced by wrongly mated pairs
-	float C_S = 0; // coverage induced by singletons
-	float C_D = 0; // coverage induced by reads with mate on a different contigs
-
-	// compute mean and std on the fly
-	float Mk = 0;
-	float Qk = 0;
-	uint32_t counterK = 1;
-	//Keep header for further reference
-	int32_t currentTid = -1;
-	int32_t iSize;
-
-	BamAlignment al;
-	while ( bamFile.GetNextAlignmentCore(al) ) {
+	uint32_t matedDifferentContig; // number of contig placed in a different contig
+	uint64_t matedDifferentContigLength; // total number of reads placed in different contigs
+
+	libraryCounts() {
+		memset(this, 0, sizeof(libraryCounts));
+	}
+
+	void add(const alignmentCore &al, uint32_t max_insert, bool is_mp) {
 		reads ++;
 		readStatus read_status = computeReadType(al, max_insert, is_mp);
 		if (read_status != unmapped and read_status != lowQualty) {
@@ -266,19 +273,10 @@ static LibraryStatistics computeLibraryStats(string bamFileName, uint64_t genome
 		}
 
 		if (al.IsFirstMate() && read_status == pair_proper) {
-			iSize = abs(al.InsertSize);
-			if(counterK == 1) {
-				Mk = iSize;
-				Qk = 0;
-				counterK++;
-			} else {
-				float oldMk = Mk;
-				float oldQk = Qk;
-				Mk = oldMk + (iSize - oldMk)/counterK;
-				Qk = oldQk + (counterK-1)*(iSize - oldMk)*(iSize - oldMk)/(float)counterK;
-				counterK++;
-			}
+			int32_t iSize = abs(al.InsertSize);
 			insertsLength += iSize;
+			insertsSquares += (uint64_t)iSize * iSize;
+			inserts ++;
 		}
 
 		switch (read_status) {
@@ -312,37 +310,124 @@ static LibraryStatistics computeLibraryStats(string bamFileName, uint64_t genome
 		     cout << "This should never be printed\n";
 		     break;
 		}
+	}
 
+	// sums the counts of another part of the file
+	void merge(const libraryCounts &other) {
+		reads                      += other.reads;
+		unmappedReads              += other.unmappedReads;
+		lowQualityReads            += other.lowQualityReads;
+		mappedReads                += other.mappedReads;
+		mappedReadsLength          += other.mappedReadsLength;
+		insertsLength              += other.insertsLength;
+		insertsSquares             += other.insertsSquares;
+		inserts                    += other.inserts;
+		matedReads                 += other.matedReads;
+		matedReadsLength           += other.matedReadsLength;
+		wrongDistanceReads         += other.wrongDistanceReads;
+		wrongDistanceReadsLength   += other.wrongDistanceReadsLength;
+		wronglyOrientedReads       += other.wronglyOrientedReads;
+		wronglyOrientedReadsLength += other.wronglyOrientedReadsLength;
+		singletonReads             += other.singletonReads;
+		singletonReadsLength       += other.singletonReadsLength;
+		matedDifferentContig       += other.matedDifferentContig;
+		matedDifferentContigLength += other.matedDifferentContigLength;
 	}
 
-	library.reads                 =  reads;
-	library.mappedReads           =  mappedReads;
-	library.unmappedReads         = unmappedReads;
-	library.matedReads            = matedReads ;
-	library.wrongDistanceReads    = wrongDistanceReads;
-	library.lowQualityReads       = lowQualityReads ;
-	library.wronglyOrientedReads  = wronglyOrientedReads ;
-	library.matedDifferentContig  = matedDifferentContig ;
-	library.singletonReads        =  singletonReads ;
-
-	uint32_t total = matedReads + wrongDistanceReads +  wronglyOrientedReads +  matedDifferentContig + singletonReads  ;
-
-	library.C_A = C_A = mappedReadsLength/(float)genomeLength;
-	library.S_A = S_A = insertsLength/(float)genomeLength;
-	library.C_M = C_M = matedReadsLength/(float)genomeLength;
-	library.C_W = C_W = wronglyOrientedReadsLength/(float)genomeLength;
-	library.C_S = C_S = singletonReadsLength/(float)genomeLength;
-	library.C_D = C_D = matedDifferentContigLength/(float)genomeLength;
-	library.insertMean = insertMean = Mk;
-	Qk = sqrt(Qk/counterK);
-	library.insertStd = insertStd = Qk;
+	// counts of a sample of the file scaled to the whole file, insert size mean and std stay the same
+	void scale(double factor) {
+		reads                      = reads * factor + 0.5;
+		unmappedReads              = unmappedReads * factor + 0.5;
+		lowQualityReads            = lowQualityReads * factor + 0.5;
+		mappedReads                = mappedReads * factor + 0.5;
+		mappedReadsLength          = mappedReadsLength * factor + 0.5;
+		insertsLength              = insertsLength * factor + 0.5;
+		insertsSquares             = insertsSquares * factor + 0.5;
+		inserts                    = inserts * factor + 0.5;
+		matedReads                 = matedReads * factor + 0.5;
+		matedReadsLength           = matedReadsLength * factor + 0.5;
+		wrongDistanceReads         = wrongDistanceReads * factor + 0.5;
+		wrongDistanceReadsLength   = wrongDistanceReadsLength * factor + 0.5;
+		wronglyOrientedReads       = wronglyOrientedReads * factor + 0.5;
+		wronglyOrientedReadsLength = wronglyOrientedReadsLength * factor + 0.5;
+		singletonReads             = singletonReads * factor + 0.5;
+		singletonReadsLength       = singletonReadsLength * factor + 0.5;
+		matedDifferentContig       = matedDifferentContig * factor + 0.5;
+		matedDifferentContigLength = matedDifferentContigLength * factor + 0.5;
+	}
+
+	LibraryStatistics statistics(uint64_t genomeLength) const {
+		LibraryStatistics library;
+		library.reads                 =  reads;
+		library.mappedReads           =  mappedReads;
+		library.unmappedReads         = unmappedReads;
+		library.matedReads            = matedReads ;
+		library.wrongDistanceReads    = wrongDistanceReads;
+		library.lowQualityReads       = lowQualityReads ;
+		library.wronglyOrientedReads  = wronglyOrientedReads ;
+		library.matedDifferentContig  = matedDifferentContig ;
+		library.singletonReads        =  singletonReads ;
+
+		library.C_A = mappedReadsLength/(float)genomeLength;
+		library.S_A = insertsLength/(float)genomeLength;
+		library.C_M = matedReadsLength/(float)genomeLength;
+		library.C_W = wronglyOrientedReadsLength/(float)genomeLength;
+		library.C_S = singletonReadsLength/(float)genomeLength;
+		library.C_D = matedDifferentContigLength/(float)genomeLength;
+		library.insertMean = 0;
+		library.insertStd  = 0;
+		if(inserts > 0) {
+			long double mean       = insertsLength/(long double)inserts;
+			long double deviations = insertsSquares - mean*insertsLength; // sum of the squared deviations
+			library.insertMean = mean;
+			library.insertStd  = sqrt(max((long double)0, deviations)/(inserts + 1)); // over inserts + 1, as the running estimate always did
+		}
+		library.sampled         = false;
+		library.sampledFraction = 1;
+		library.insertMeanError = 0;
+		library.insertStdError  = 0;
+		library.C_A_error       = 0;
+		library.C_M_error       = 0;
+		return library;
+	}
+};
+
+
+// file name without directories and extension (a .gz one too, as in lib.sam.gz)
+static string libraryName(string alignmentFileName) {
+	boost::filesystem::path name = boost::filesystem::path(alignmentFileName).filename();
+	if(name.extension() == ".gz") {
+		name = name.stem();
+	}
+	return name.stem().string();
+}
+
+
+// countsOut, if given, is filled with the counts the statistics are computed from
+static LibraryStatistics computeLibraryStats(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp, unsigned int readAhead = 0,
+		libraryCounts *countsOut = NULL) {
+	AlignmentReader bamFile;
+	bamFile.SetReadAhead(readAhead);
+	bamFile.Open(bamFileName);
+	libraryCounts counts;
+
+	alignmentCore al;
+	while ( bamFile.GetNextAlignmentCore(al) ) {
+		counts.add(al, max_insert, is_mp);
+	}
+
+	LibraryStatistics library = counts.statistics(genomeLength);
+	library.library_name = libraryName(bamFileName);
+	if(countsOut != NULL) {
+		*countsOut = counts;
+	}
 
 	bamFile.Close();
 	return library;
 }
 
 
-static void print_contigMetricsFileHeader(ofstream &ContigMetricsFile) {
+static void print_contigMetricsFileHeader(TextWriter &ContigMetricsFile) {
 	ContigMetricsFile << "contigID" << ","; //contigID
 	ContigMetricsFile << "READ_COVERAGE" << ",";//read coverage
 	ContigMetricsFile << "SPAN_COVERAGE" << ",";// span coverage
@@ -354,7 +439,7 @@ static void print_contigMetricsFileHeader(ofstream &ContigMetricsFile) {
 
 }
 
-static void print_AssemblyMetrics(LibraryStatistics library, string type , ofstream &AssemblyMetricsFile) {
+static void print_AssemblyMetrics(const LibraryStatistics &library, string type , TextWriter &AssemblyMetricsFile) {
 	AssemblyMetricsFile << "###LIBRARY STATISTICS\n";
 	AssemblyMetricsFile << "BAM,LIB_TYPE,InsertSizeMean,InsertSizeStd,READS,MAPPED,UNMAPPED,PROPER,WRONG_DIST,ZERO_QUAL,WRONG_ORIENTATION,WRONG_CONTIG,";
 	AssemblyMetricsFile << "SINGLETON,MEAN_COVERAGE,SPANNING_COVERAGE,PROPER_PAIRS_COVERAGE,WRONG_MATE_COVERAGE,SINGLETON_MATE_COV,DIFFERENT_CONTIG_COV\n";
@@ -383,6 +468,18 @@ static void print_AssemblyMetrics(LibraryStatistics library, string type , ofstr
 
 	AssemblyMetricsFile 								<<  "\n";
 
+	if(library.sampled) { // statistics estimated on random regions, 95% confidence half widths
+		AssemblyMetricsFile << "###SAMPLING ERROR\n";
+		AssemblyMetricsFile << "BAM,LIB_TYPE,SAMPLED_FRACTION,InsertSizeMean_ERR,InsertSizeStd_ERR,MEAN_COVERAGE_ERR,PROPER_PAIRS_COVERAGE_ERR\n";
+		AssemblyMetricsFile << library.library_name    << ",";
+		AssemblyMetricsFile << type                    << ",";
+		AssemblyMetricsFile << library.sampledFraction << ",";
+		AssemblyMetricsFile << library.insertMeanError << ",";
+		AssemblyMetricsFile << library.insertStdError  << ",";
+		AssemblyMetricsFile << library.C_A_error       << ",";
+		AssemblyMetricsFile << library.C_M_error       << "\n";
+	}
+
 
 }
 
@@ -0,0 +1,48 @@
+#ifndef ALIGNMENTCORE_H_
+#define ALIGNMENTCORE_H_
+
+#include <stdint.h>
+
+#include "api/BamAlignment.h"
+#include "api/BamConstants.h"
+
+using namespace BamTools;
+using namespace std;
+
+
+/*
+ * The alignment fields used by FRC: a plain record, cheap to copy and to pass around.
+ * Field and method names follow BamAlignment.
+ */
+struct alignmentCore {
+	int32_t  RefID;
+	int32_t  Position;
+	uint32_t AlignmentFlag;
+	int32_t  MateRefID;
+	int32_t  MatePosition;
+	int32_t  InsertSize;
+	uint32_t Length; // query length
+
+	bool IsMapped() const            { return (AlignmentFlag & Constants::BAM_ALIGNMENT_UNMAPPED) == 0; }
+	bool IsMateMapped() const        { return (AlignmentFlag & Constants::BAM_ALIGNMENT_MATE_UNMAPPED) == 0; }
+	bool IsReverseStrand() const     { return (AlignmentFlag & Constants::BAM_ALIGNMENT_REVERSE_STRAND) != 0; }
+	bool IsMateReverseStrand() const { return (AlignmentFlag & Constants::BAM_ALIGNMENT_MATE_REVERSE_STRAND) != 0; }
+	bool IsFirstMate() const         { return (AlignmentFlag & Constants::BAM_ALIGNMENT_READ_1) != 0; }
+	bool IsPrimaryAlignment() const  { return (AlignmentFlag & Constants::BAM_ALIGNMENT_SECONDARY) == 0; }
+	bool IsFailedQC() const          { return (AlignmentFlag & Constants::BAM_ALIGNMENT_QC_FAILED) != 0; }
+	bool IsDuplicate() const         { return (AlignmentFlag & Constants::BAM_ALIGNMENT_DUPLICATE) != 0; }
+};
+
+// fills core from an alignment read with BamReader::GetNextAlignmentCore (no character data is touched)
+static inline void decodeAlignmentCore(const BamAlignment &al, alignmentCore &core) {
+	core.RefID         = al.RefID;
+	core.Position      = al.Position;
+	core.AlignmentFlag = al.AlignmentFlag;
+	core.MateRefID     = al.MateRefID;
+	core.MatePosition  = al.MatePosition;
+	core.InsertSize    = al.InsertSize;
+	core.Length        = al.Length;
+}
+
+
+#endif /* ALIGNMENTCORE_H_ */
@@ -0,0 +1,91 @@
+#include "AlignmentReader.h"
+#include <zlib.h>
+#include <boost/filesystem.hpp>
+#include "RunReport.h"
+
+
+bool isBamFile(string fileName) {
+	gzFile file = gzopen(fileName.c_str(), "rb");
+	if(file == NULL) {
+		return false;
+	}
+	char magic[4];
+	bool bam = gzread(file, magic, 4) == 4 and memcmp(magic, Constants::BAM_HEADER_MAGIC, 4) == 0;
+	gzclose(file);
+	return bam;
+}
+
+
+AlignmentReader::AlignmentReader() : isSam(false), readAhead(0), alignments(0), bytes(0), atEnd(false) {}
+
+AlignmentReader::~AlignmentReader() {
+	Close();
+}
+
+
+void AlignmentReader::SetReadAhead(unsigned int readAhead) {
+	this->readAhead = readAhead;
+}
+
+
+bool AlignmentReader::Open(string fileName) {
+	this->fileName   = fileName;
+	this->alignments = 0;
+	this->bytes      = 0;
+	this->atEnd      = false;
+	isSam = !isBamFile(fileName);
+	if(isSam) {
+		sam.SetParsers(readAhead);
+		return sam.Open(fileName);
+	}
+	bam.SetReadAhead(readAhead);
+	return bam.Open(fileName);
+}
+
+
+void AlignmentReader::Close() {
+	if(alignments > 0) { // the compressed bytes are known only for whole files
+		boost::system::error_code error;
+		uint64_t compressed = atEnd ? boost::filesystem::file_size(fileName, error) : 0;
+		RunReport::addReads(alignments, isSam ? sam.GetBytesRead() : bytes, error ? 0 : compressed);
+		alignments = 0;
+	}
+	if(isSam) {
+		sam.Close();
+	} else {
+		bam.Close();
+	}
+}
+
+
+bool AlignmentReader::IsSam() const {
+	return isSam;
+}
+
+
+SamHeader AlignmentReader::GetHeader() const {
+	return isSam ? sam.GetHeader() : bam.GetHeader();
+}
+
+string AlignmentReader::GetHeaderText() const {
+	return isSam ? sam.GetHeaderText() : bam.GetHeaderText();
+}
+
+RefVector AlignmentReader::GetReferenceData() const {
+	return isSam ? sam.GetReferenceData() : bam.GetReferenceData();
+}
+
+
+bool AlignmentReader::GetNextAlignmentCore(alignmentCore &al) {
+	bool read = isSam ? sam.GetNextAlignmentCore(al) : bam.GetNextAlignmentCore(alignment);
+	if(!read) {
+		atEnd = true;
+		return false;
+	}
+	if(!isSam) {
+		decodeAlignmentCore(alignment, al);
+		bytes += alignment.GetBlockLength() + sizeof(uint32_t); // the record and its length
+	}
+	alignments++;
+	return true;
+}
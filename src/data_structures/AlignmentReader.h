@@ -0,0 +1,50 @@
+#ifndef ALIGNMENTREADER_H_
+#define ALIGNMENTREADER_H_
+
+#include <string>
+
+#include "api/BamReader.h"
+#include "AlignmentCore.h"
+#include "SamReader.h"
+
+using namespace std;
+using namespace BamTools;
+
+
+bool isBamFile(string fileName); // BAM magic after gunzipping, false for SAM (plain or gzip) files
+
+
+/*
+ * Reads the alignments of a BAM or of a SAM (plain or gzip) file, told apart by their content.
+ * Method names follow BamReader.
+ */
+class AlignmentReader {
+	BamReader bam;
+	SamReader sam;
+	BamAlignment alignment;
+	bool isSam;
+	unsigned int readAhead;
+	string fileName;
+	uint64_t alignments; // read so far, with their BAM records
+	uint64_t bytes;
+	bool atEnd;
+
+public:
+	AlignmentReader();
+	~AlignmentReader();
+
+	// BAM blocks decompressed ahead (see BamReader), or SAM parsing threads
+	void SetReadAhead(unsigned int readAhead);
+	bool Open(string fileName);
+	void Close(); // the alignments read go in the RunReport
+	bool IsSam() const;
+
+	SamHeader GetHeader() const;
+	string GetHeaderText() const;
+	RefVector GetReferenceData() const;
+
+	bool GetNextAlignmentCore(alignmentCore &al);
+};
+
+
+#endif /* ALIGNMENTREADER_H_ */
@@ -0,0 +1,59 @@
+#ifndef BOUNDEDQUEUE_H_
+#define BOUNDEDQUEUE_H_
+
+#include <deque>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+using namespace std;
+
+
+/*
+ * FIFO connecting two pipeline stages. push() blocks while the queue is full (backpressure on the producer),
+ * pop() blocks while it is empty and returns false once the queue has been closed and drained.
+ */
+template<class T>
+class BoundedQueue {
+	deque<T> items;
+	size_t capacity;
+	bool closed;
+
+	boost::mutex lock;
+	boost::condition_variable notEmpty;
+	boost::condition_variable notFull;
+
+public:
+	BoundedQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1), closed(false) {}
+
+	void push(const T &item) {
+		boost::unique_lock<boost::mutex> guard(lock);
+		while(items.size() >= capacity) {
+			notFull.wait(guard);
+		}
+		items.push_back(item);
+		notEmpty.notify_one();
+	}
+
+	bool pop(T &item) {
+		boost::unique_lock<boost::mutex> guard(lock);
+		while(items.empty() and !closed) {
+			notEmpty.wait(guard);
+		}
+		if(items.empty()) {
+			return false;
+		}
+		item = items.front();
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close() { // no more items will be pushed
+		boost::unique_lock<boost::mutex> guard(lock);
+		closed = true;
+		notEmpty.notify_all();
+	}
+};
+
+
+#endif /* BOUNDEDQUEUE_H_ */
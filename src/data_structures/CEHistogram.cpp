@@ -0,0 +1,73 @@
+#include "CEHistogram.h"
+#include <cmath>
+
+
+#define CE_HISTOGRAM_OFFSET (CE_HISTOGRAM_MAX*CE_HISTOGRAM_RESOLUTION)
+
+
+CEHistogram::CEHistogram() : bins(2*CE_HISTOGRAM_OFFSET + 1, 0) {}
+
+
+void CEHistogram::add(float CE) {
+	float bin = floorf(CE * CE_HISTOGRAM_RESOLUTION);
+	if(bin != bin) { // NaN, no inserts to compare with
+		return;
+	}
+	if(bin < -CE_HISTOGRAM_OFFSET or bin > CE_HISTOGRAM_OFFSET) {
+		outside[bin]++;
+	} else {
+		bins[(int)bin + CE_HISTOGRAM_OFFSET]++;
+	}
+}
+
+
+void CEHistogram::merge(const CEHistogram &other) {
+	for(unsigned int i = 0; i < bins.size(); i++) {
+		bins[i] += other.bins[i];
+	}
+	for(map<float, uint32_t>::const_iterator value = other.outside.begin(); value != other.outside.end(); ++value) {
+		outside[value->first] += value->second;
+	}
+}
+
+
+uint64_t CEHistogram::total() const {
+	uint64_t total = 0;
+	for(unsigned int i = 0; i < bins.size(); i++) {
+		total += bins[i];
+	}
+	for(map<float, uint32_t>::const_iterator value = outside.begin(); value != outside.end(); ++value) {
+		total += value->second;
+	}
+	return total;
+}
+
+
+void CEHistogram::printCumulative(TextWriter &file, bool is_mp) const {
+	// every value seen with its count, in order: the ones below the bins, the bins, the ones above
+	vector<pair<float, uint32_t> > values;
+	map<float, uint32_t>::const_iterator above = outside.begin();
+	for(; above != outside.end() and above->first < 0; ++above) {
+		values.push_back(*above);
+	}
+	for(unsigned int i = 0; i < bins.size(); i++) {
+		if(bins[i] > 0) {
+			values.push_back(make_pair((float)((int)i - CE_HISTOGRAM_OFFSET), bins[i]));
+		}
+	}
+	values.insert(values.end(), above, outside.end());
+
+	uint64_t all  = total();
+	uint64_t left = 0; // values up to the current one
+	for(unsigned int i = 0; i < values.size(); i++) {
+		float bin = values[i].first;
+		left += values[i].second;
+		uint64_t cumulative;
+		if(bin < 0 or (is_mp and bin == 0)) {
+			cumulative = left - values[0].second; // the smallest value is left out
+		} else {
+			cumulative = all - left + values[i].second;
+		}
+		file << bin / CE_HISTOGRAM_RESOLUTION << " " << (unsigned int)cumulative << "\n";
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef CEHISTOGRAM_H_
+#define CEHISTOGRAM_H_
+
+#include <vector>
+#include <map>
+#include <ostream>
+
+#include "common.h"
+
+using namespace std;
+
+
+#define CE_HISTOGRAM_RESOLUTION 10   // bins per unit of CE statistics (values are floored to 0.1)
+#define CE_HISTOGRAM_MAX        1000 // CE statistics beyond +-CE_HISTOGRAM_MAX (rare) are kept in a map
+
+
+/*
+ * Distribution of the CE statistics of a library over fixed bins: adding a value is an index computation, histograms
+ * filled by different threads are merged bin by bin and the cumulative totals are computed in a single pass.
+ */
+class CEHistogram {
+	vector<uint32_t> bins; // bins[k + CE_HISTOGRAM_MAX*CE_HISTOGRAM_RESOLUTION]: values with floor(value*10) == k
+	map<float, uint32_t> outside; // floor(value*10) beyond the bins (also +-inf, when the insert size std is 0): values with it
+
+public:
+	CEHistogram();
+
+	void add(float CE);
+	void merge(const CEHistogram &other);
+	uint64_t total() const;
+
+	/*
+	 * One line per CE value seen, "value total": values below 0 (or 0 for MP) count the values at their left, excluded
+	 * the smallest one, the others count the values at their right, included themselves.
+	 */
+	void printCumulative(TextWriter &file, bool is_mp) const;
+};
+
+
+#endif /* CEHISTOGRAM_H_ */
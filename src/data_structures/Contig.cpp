@@ -21,22 +21,6 @@ ContigsFeat::~ContigsFeat() {
 
 
 
-Position::Position() {
-	ReadCoverage = 0;
-	StratingInserts = 0;
-	InsertCoverage = 0;
-	CorrectlyMated = 0;
-	WronglyOriented = 0;
-	Singleton = 0;
-	MatedDifferentContig = 0;
-	insertsLength = 0;
-}
-
-Position::~Position() {
-
-}
-
-
 Contig::Contig() {
 	contigLength = 0;
 	MINUM_COV = 0;
@@ -48,11 +32,12 @@ Contig::Contig() {
 	highSingleFeat = 0.4;
 	highSpanningFeat = 0.51;
 	highOutieFeat = 0.51;
+	binSize = 1;
+	allocateTracks(0);
 }
 
 Contig::Contig(unsigned int contigLength) {
 	this->contigLength = contigLength;
-	this->CONTIG =  new Position[contigLength];
 	MINUM_COV = 2;
 
 	lowCoverageFeat = 1/(float)2;
@@ -62,13 +47,12 @@ Contig::Contig(unsigned int contigLength) {
 	highSingleFeat = 0.41;
 	highSpanningFeat = 0.41;
 	highOutieFeat = 0.41;
+	binSize = 1;
+	allocateTracks(PE_TRACKS);
 }
 
 
-Contig::Contig(string contigID, unsigned int contigLength) {
-	this->contigLength = contigLength;
-	this->CONTIG       =  new Position[contigLength];
-	this->contigID     = contigID;
+Contig::Contig(string contigID, unsigned int contigLength, unsigned int trackMask, unsigned int binSize) {
 	MINUM_COV = 2;
 
 	lowCoverageFeat = 1/(float)2;
@@ -78,46 +62,90 @@ Contig::Contig(string contigID, unsigned int contigLength) {
 	highSingleFeat = 0.41;
 	highSpanningFeat = 0.41;
 	highOutieFeat = 0.41;
+	reset(contigID, contigLength, trackMask, binSize);
 }
 
 
 
 Contig::~Contig() {
-	if(CONTIG != NULL) {
-		delete [] CONTIG;
+
+}
+
+
+void Contig::reset(string contigID, unsigned int contigLength, unsigned int trackMask, unsigned int binSize) {
+	this->contigLength = contigLength;
+	this->contigID     = contigID;
+	this->binSize      = binSize > 0 ? binSize : 1;
+	allocateTracks(trackMask);
+
+	// keep the memory of the area vectors
+	lowCoverageAreas.clear();
+	highCoverageAreas.clear();
+	lowNormalAreas.clear();
+	highNormalAreas.clear();
+	highSingleAreas.clear();
+	highSpanningAreas.clear();
+	highOutieAreas.clear();
+	compressionAreas.clear();
+	expansionAreas.clear();
+}
+
+
+void Contig::allocateTracks(unsigned int trackMask) {
+	this->trackMask = trackMask;
+	this->tracksOnDisk = false;
+	this->trimmed      = 0;
+	for(unsigned int type = 0; type < COV_TYPES; type++) {
+		coverageTotal[type] = 0;
+		if(trackMask & TRACK(type)) {
+			tracks[type].resize(this->contigLength, this->binSize);
+			tracksOnDisk = tracksOnDisk or tracks[type].onDisk();
+		} else {
+			tracks[type].release();
+		}
 	}
+	inserts.clear();
 }
 
 
-void Contig::updateCov(unsigned int start, unsigned int end, data type) {
+void Contig::trimTracks(unsigned int start, unsigned int end) {
+	for(unsigned int type = 0; type < COV_TYPES; type++) {
+		if(trackMask & TRACK(type)) {
+			tracks[type].trim(start, end);
+		}
+	}
+}
+
+
+bool Contig::hasTrack(covType type) {
+	return (trackMask & TRACK(type)) != 0;
+}
+
+const Track & Contig::getTrack(covType type) {
+	return tracks[type];
+}
+
+
+void Contig::updateCov(unsigned int start, unsigned int end, covType type) {
 	if(end > this->contigLength) {
 //		cout << "hoops, end longer than contig length when updating CONTIG " << type << "\n";
 //		cout << "\tcontig length " << this->contigLength << " starting point " << start << " ending point " << end << "\n";
 		end = this->contigLength;
 	}
-	// now update
-	if(type == insertCov) {
-		CONTIG[start].StratingInserts++; // a new inserts starts in position start
-		CONTIG[start].insertsLength += (end - start + 1); // save total length of inserts starting at start
-		for(unsigned int i = start; i< end; i++)
-			CONTIG[i].InsertCoverage++;
-	} else if(type == readCov) {
-		for(unsigned int i = start; i< end; i++)
-			CONTIG[i].ReadCoverage++;
-	} else if(type ==  cmCov) {
-		for(unsigned int i = start; i< end; i++)
-			CONTIG[i].CorrectlyMated++;
-	} else if(type == woCov) {
-		for(unsigned int i = start; i< end; i++)
-			CONTIG[i].WronglyOriented++;
-	} else if(type == singCov) {
-		for(unsigned int i = start; i< end; i++)
-			CONTIG[i].Singleton++;
-	} else if(type == mdcCov) {
-		for(unsigned int i = start; i< end; i++)
-			CONTIG[i].MatedDifferentContig++;
-	} else {
+	if(type >= COV_TYPES) {
 		cout << "hoops, unknown type " << type << " there must be something wrong!!!\n";
+		return;
+	}
+	// now update
+	if(type == insertCov and start < this->contigLength) {
+		inserts.add(start, end - start + 1); // a new inserts starts in position start, save its length
+	}
+	if(start >= end) {
+		return;
+	}
+	coverageTotal[type] += end - start;
+	if(trackMask & TRACK(type)) { // only the interval end points are touched, finalize() computes the per base values
+		tracks[type].addInterval(start, end);
 	}
 }
 
@@ -126,9 +154,65 @@ unsigned int Contig::getContigLength() {
 }
 
 
+void Contig::finalize() {
+	for(unsigned int type = 0; type < COV_TYPES; type++) {
+		if(trackMask & TRACK(type)) {
+			tracks[type].materialize();
+		}
+	}
+	inserts.finalize(); // merge inserts starting in the same position
+}
+
+
+const InsertTrack & Contig::getInserts() {
+	return inserts;
+}
+
+
+void Contig::writeSummary(FILE *file) {
+	unsigned int idLength = contigID.size();
+	fwrite(&idLength, sizeof(idLength), 1, file);
+	fwrite(contigID.data(), 1, idLength, file);
+	fwrite(&contigLength, sizeof(contigLength), 1, file);
+	fwrite(&trackMask, sizeof(trackMask), 1, file);
+	fwrite(&binSize, sizeof(binSize), 1, file);
+	fwrite(coverageTotal, sizeof(coverageTotal[0]), COV_TYPES, file);
+	for(unsigned int type = 0; type < COV_TYPES; type++) {
+		if(trackMask & TRACK(type)) {
+			tracks[type].write(file);
+		}
+	}
+	inserts.write(file);
+}
+
+
+bool Contig::readSummary(FILE *file) {
+	unsigned int idLength, length, mask, bin;
+	if(fread(&idLength, sizeof(idLength), 1, file) != 1) {
+		return false;
+	}
+	string id(idLength, ' ');
+	if(idLength > 0 and fread(&id[0], 1, idLength, file) != idLength) {
+		return false;
+	}
+	if(fread(&length, sizeof(length), 1, file) != 1 or fread(&mask, sizeof(mask), 1, file) != 1 or fread(&bin, sizeof(bin), 1, file) != 1) {
+		return false;
+	}
+	reset(id, length, mask, bin);
+	if(fread(coverageTotal, sizeof(coverageTotal[0]), COV_TYPES, file) != COV_TYPES) {
+		return false;
+	}
+	for(unsigned int type = 0; type < COV_TYPES; type++) {
+		if((trackMask & TRACK(type)) and !tracks[type].read(file)) {
+			return false;
+		}
+	}
+	return inserts.read(file);
+}
+
 
 
-void Contig::updateContig(BamAlignment b, int max_nsert, bool is_mp) {
+void Contig::updateContig(const alignmentCore &b, int max_nsert, bool is_mp) {
 	readStatus read_status 	= computeReadType(b, max_nsert, is_mp);
 	uint32_t readLength     = b.Length;
 	uint32_t iSize 			= abs(b.InsertSize);
@@ -138,6 +222,10 @@ void Contig::updateContig(BamAlignment b, int max_nsert, bool is_mp) {
 	if (read_status == unmapped or read_status == lowQualty) {
 		return;
 	}
+	if (tracksOnDisk and startRead >= trimmed + TRIM_BASES) { // no track is updated before startRead any more
+		trimTracks(trimmed, startRead);
+		trimmed = startRead;
+	}
 	if (read_status != unmapped and read_status != lowQualty) { //if the read is aligned and is not duplicated or low quality use it in cov computation
 		updateCov(startRead, endRead, readCov); // update coverage
 	}
@@ -176,79 +264,61 @@ void Contig::updateContig(BamAlignment b, int max_nsert, bool is_mp) {
 
 void Contig::print() {
 	cout << "Contig size " << this->contigLength << "\n";
-	for(unsigned int i= 0; i < this->contigLength; i++) {
+	unsigned int bins = (this->contigLength + binSize - 1) / binSize; // binned tracks print the sum over each bin
+	for(unsigned int i= 0; i < bins; i++) {
 		if(i % 6 == 0 && i > 0) {
 			cout << "\n";
 		}
-		cout << "(" << i << ":" << this->CONTIG[i].ReadCoverage  << "," << this->CONTIG[i].InsertCoverage << "," << this->CONTIG[i].CorrectlyMated << "," <<
-				this->CONTIG[i].MatedDifferentContig  << "," << "," <<   this->CONTIG[i].Singleton << "," <<   this->CONTIG[i].WronglyOriented
-				<< "," << this->CONTIG[i].StratingInserts << ") " ;
+		cout << "(" << i * binSize;
+		for(unsigned int type = 0; type < COV_TYPES; type++) {
+			cout << ",";
+			if(trackMask & TRACK(type)) {
+				cout << tracks[type].get(i);
+			}
+		}
+		cout << ") " ;
 	}
 	cout << "\n\n";
 }
 
 
-void Contig::printContigMetrics(ofstream &ContigsMetricsFile) {
+void Contig::printContigMetrics(TextWriter &ContigsMetricsFile) {
 	ContigsMetricsFile << this->contigID << ",";
 	//compute read coverage
-	unsigned int totalCoverage = 0;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalCoverage += CONTIG[i].ReadCoverage;
-	}
-	float readCoverage = totalCoverage/(float)this->contigLength;
+	float readCoverage = coverageTotal[readCov]/(float)this->contigLength;
 	ContigsMetricsFile << readCoverage << ",";
 
 
 	//compute span coverage
-	unsigned int totalInsertCoverage = 0;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalInsertCoverage += CONTIG[i].InsertCoverage;
-	}
-	float insertCoverage = totalInsertCoverage/(float)this->contigLength;
+	float insertCoverage = coverageTotal[insertCov]/(float)this->contigLength;
 	ContigsMetricsFile << insertCoverage << ",";
 
 
 	//compute mean insert size
 	unsigned long int totalInsertSize = 0;
 	unsigned int      numberOfInserts = 0;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalInsertSize += CONTIG[i].insertsLength * CONTIG[i].StratingInserts;
-		numberOfInserts += CONTIG[i].StratingInserts;
+	for(unsigned int i=0; i < this->inserts.size() ; i++ ) {
+		totalInsertSize += inserts[i].insertsLength * inserts[i].inserts;
+		numberOfInserts += inserts[i].inserts;
 	}
 	float insertMean = totalInsertSize/(float)numberOfInserts;
 	ContigsMetricsFile << insertMean << ",";
 
 
 	//compute correctly mated coverage
-	unsigned int totalCorrentlyMatedCoverage = 0;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalCorrentlyMatedCoverage += CONTIG[i].CorrectlyMated;
-	}
-	float correntlyMatedCoverage = totalCorrentlyMatedCoverage/(float)this->contigLength;
+	float correntlyMatedCoverage = coverageTotal[cmCov]/(float)this->contigLength;
 	ContigsMetricsFile << correntlyMatedCoverage << ",";
 
 	//compute wrongly oriented coverage
-	unsigned int totalWronglyOrientedCoverage = 0;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalWronglyOrientedCoverage += CONTIG[i].WronglyOriented;
-	}
-	float wronglyOrientedCoverage = totalWronglyOrientedCoverage/(float)this->contigLength;
+	float wronglyOrientedCoverage = coverageTotal[woCov]/(float)this->contigLength;
 	ContigsMetricsFile << wronglyOrientedCoverage << ",";
 
 	//computed singleton coverage
-	unsigned int totalSingletonCoverage = 0;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalSingletonCoverage += CONTIG[i].Singleton;
-	}
-	float singletonCoverage = totalSingletonCoverage/(float)this->contigLength;
+	float singletonCoverage = coverageTotal[singCov]/(float)this->contigLength;
 	ContigsMetricsFile << singletonCoverage << ",";
 
 	//compute Mated Different Contigs
-	unsigned int totalMatedDifferentCoverage = 0;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalMatedDifferentCoverage += CONTIG[i].MatedDifferentContig;
-	}
-	float matedDifferentCoverage = totalMatedDifferentCoverage/(float)this->contigLength;
+	float matedDifferentCoverage = coverageTotal[mdcCov]/(float)this->contigLength;
 	ContigsMetricsFile << matedDifferentCoverage ;
 
 
@@ -258,943 +328,326 @@ void Contig::printContigMetrics(ofstream &ContigsMetricsFile) {
 
 
 float Contig::getCoverage() {
-	//compute length of low coverage areas in the contig
-	//use a 1K sliding window
-
-	unsigned int totalCoverage = 0;
 	float meanCov;
-	for(unsigned int i=0; i < this->contigLength ; i++ ) {
-		totalCoverage += CONTIG[i].ReadCoverage;
-	}
-	meanCov = totalCoverage/(float)this->contigLength; // this is the "window" coverage
+	meanCov = coverageTotal[readCov]/(float)this->contigLength; // this is the "window" coverage
 	return meanCov;
 
 }
 
 
-unsigned int Contig::getLowCoverageAreas(float C_A, unsigned int windowSize, unsigned int windowStep) {
-	//compute length of low coverage areas in the contig
-	//use a 1K sliding window
+/*
+ * Window predicates: each one computes the window means exactly as the feature definitions do,
+ * the sums come from the cumulative tracks in constant time.
+ */
+struct lowCoverageWindow {
+	const WindowSums<Track> &readSums;
+	float threshold;
+	float minimumCoverage;
+
+	lowCoverageWindow(const WindowSums<Track> &readSums, float threshold, float minimumCoverage) :
+		readSums(readSums), threshold(threshold), minimumCoverage(minimumCoverage) {}
+
+	bool operator()(unsigned int start, unsigned int end) {
+		unsigned int totalCoverage = readSums.sum(start, end);
+		float meanCov = totalCoverage/(float)(end - start); // compute window coverage
+		return meanCov < threshold and meanCov > minimumCoverage;
+	}
+};
 
-	unsigned int totalCoverage = 0;
-	unsigned int features = 0;
-	float meanCov;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage;
-		}
-		meanCov = totalCoverage/(float)this->contigLength; // this is the "window" coverage
-		if(meanCov < lowCoverageFeat*C_A and meanCov > MINUM_COV ) { // this is a feature
-			features = 1; // one feature found (in one window)
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->lowCoverageAreas.push_back(SS);
-			//Areas->feature=1;
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		unsigned int winSize     = windowSize;
-		for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].ReadCoverage;
-		}
-		meanCov = totalCoverage/(float)winSize; // first window's covrage
-		if(meanCov < lowCoverageFeat*C_A and meanCov > MINUM_COV ) { // in the first window already present a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
-		}
+struct highCoverageWindow {
+	const WindowSums<Track> &readSums;
+	float threshold;
 
-		//cout << feat << " " << startWindow << " " << meanCov << " " << lowCoverageFeat*C_A << "\n";
+	highCoverageWindow(const WindowSums<Track> &readSums, float threshold) :
+		readSums(readSums), threshold(threshold) {}
 
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
+	bool operator()(unsigned int start, unsigned int end) {
+		unsigned int totalCoverage = readSums.sum(start, end);
+		float meanCov = totalCoverage/(float)(end - start); // compute window coverage
+		return meanCov > threshold;
+	}
+};
+
+struct lowNormalWindow {
+	const WindowSums<Track> &matedSums;
+	const WindowSums<Track> &readSums;
+	float threshold;
+	float minimumCoverage;
+
+	lowNormalWindow(const WindowSums<Track> &matedSums, const WindowSums<Track> &readSums, float threshold, float minimumCoverage) :
+		matedSums(matedSums), readSums(readSums), threshold(threshold), minimumCoverage(minimumCoverage) {}
+
+	bool operator()(unsigned int start, unsigned int end) {
+		unsigned int totalCoverage = matedSums.sum(start, end);
+		unsigned int totalCoverageRead = readSums.sum(start, end);
+		float meanCov = totalCoverage/(float)(end - start); // compute window coverage
+		float thr = totalCoverageRead/(float)(end - start);
+		return meanCov < threshold and thr > minimumCoverage;
+	}
+};
 
-		while(endWindow < this->contigLength) {
-			totalCoverage = 0; //reset window coverage
-			for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].ReadCoverage;
-			}
-			meanCov = totalCoverage/(float)(endWindow - startWindow); // compute window coverage
-			//cout << feat << " " << startWindow << " " << meanCov << " " << lowCoverageFeat*C_A << "\n";
-			if(meanCov < lowCoverageFeat*C_A and meanCov > MINUM_COV) { // in the first window already present a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->lowCoverageAreas.push_back(SS);
-					//Areas->feature+=floor((endFeat - startFeat + 1)/(float)windowSize + 0.5);
-
-
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
+struct highNormalWindow {
+	const WindowSums<Track> &matedSums;
+	float threshold;
+
+	highNormalWindow(const WindowSums<Track> &matedSums, float threshold) :
+		matedSums(matedSums), threshold(threshold) {}
+
+	bool operator()(unsigned int start, unsigned int end) {
+		unsigned int totalCoverage = matedSums.sum(start, end);
+		float meanCov = totalCoverage/(float)(end - start); // compute window coverage
+		return meanCov > threshold;
+	}
+};
+
+// fraction of the read coverage given by a single kind of reads (singletons, mates on different contigs, wrongly oriented)
+struct highFractionWindow {
+	const WindowSums<Track> &fractionSums;
+	const WindowSums<Track> &readSums;
+	float fraction;
+	float minimumCoverage;
+
+	highFractionWindow(const WindowSums<Track> &fractionSums, const WindowSums<Track> &readSums, float fraction, float minimumCoverage) :
+		fractionSums(fractionSums), readSums(readSums), fraction(fraction), minimumCoverage(minimumCoverage) {}
+
+	bool operator()(unsigned int start, unsigned int end) {
+		unsigned int totalCoverage = readSums.sum(start, end);
+		unsigned int fractionCoverage = fractionSums.sum(start, end);
+		float meanTotalCov = totalCoverage/(float)(end - start); // compute window total coverage
+		float meanFractionCov = fractionCoverage/(float)(end - start);
+		return meanFractionCov > fraction*meanTotalCov and meanTotalCov > minimumCoverage;
+	}
+};
+
+// the first sliding window of the high singleton areas needs also a read coverage above half the library coverage
+struct highSingleWindow : public highFractionWindow {
+	unsigned int windowSize;
+	float C_A;
+
+	highSingleWindow(const WindowSums<Track> &singleSums, const WindowSums<Track> &readSums, float fraction, float minimumCoverage,
+			unsigned int windowSize, float C_A) :
+		highFractionWindow(singleSums, readSums, fraction, minimumCoverage), windowSize(windowSize), C_A(C_A) {}
+
+	bool operator()(unsigned int start, unsigned int end) {
+		if(start == 0 and end == windowSize) {
+			unsigned int totalCoverage = readSums.sum(start, end);
+			float meanTotalCov = totalCoverage/(float)(end - start);
+			if(!(meanTotalCov > 0.5 * C_A)) {
+				return false;
 			}
 		}
-		//need to check if last window was a feature
-		if(feat) { //reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->lowCoverageAreas.push_back(SS);
-//			Areas->feature+=floor((endFeat - startFeat + 1)/(float)windowSize + 0.5);
-		}
+		return highFractionWindow::operator()(start, end);
 	}
+};
 
-
-	return features;
+// CE statistics of the inserts starting in the window (0 when there are too few inserts)
+static inline float windowCEstats(const WindowSums<InsertTrack> &insertSums, unsigned int start, unsigned int end,
+		float insertionMean, float insertionStd) {
+	unsigned int minInsertNum = 5;
+	insertStatistics window = insertSums.sum(start, end);
+	unsigned int inserts = window.inserts; // number of inserts
+	unsigned long int spanningCoverage = window.insertsLength; // total insert length
+	if(inserts > minInsertNum) {
+		float localMean = spanningCoverage/(float)inserts;
+		return (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
+	}
+	return 0;
 }
 
+// collects the CE statistics of every window, never opens an area
+struct CEwindow {
+	const WindowSums<InsertTrack> &insertSums;
+	float insertionMean;
+	float insertionStd;
+	vector<float> &CEvalues;
 
+	CEwindow(const WindowSums<InsertTrack> &insertSums, float insertionMean, float insertionStd, vector<float> &CEvalues) :
+		insertSums(insertSums), insertionMean(insertionMean), insertionStd(insertionStd), CEvalues(CEvalues) {}
 
-
-unsigned int  Contig::getHighCoverageAreas(float C_A, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int totalCoverage = 0;
-	unsigned int features = 0;
-	float meanCov;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage;
-		}
-		meanCov = totalCoverage/(float)this->contigLength; // this is the "window" covrage
-		if(meanCov > highCoverageFeat*C_A  ) { // this is a feature
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->highCoverageAreas.push_back(SS);
-			features = 1; // one feature found (in one window)
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		unsigned int winSize     = windowSize;
-		for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].ReadCoverage;
-		}
-		meanCov = totalCoverage/(float)winSize; // first window's covrage
-		if(meanCov > highCoverageFeat*C_A ) { // in the first window already present a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
+	bool operator()(unsigned int start, unsigned int end) {
+		if(insertSums.sum(start, end).inserts > 5) { // same minimum number of inserts of windowCEstats
+			CEvalues.push_back(windowCEstats(insertSums, start, end, insertionMean, insertionStd));
 		}
+		return false;
+	}
+};
 
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
+struct compressionWindow {
+	const WindowSums<InsertTrack> &insertSums;
+	float insertionMean;
+	float insertionStd;
+	float Zscore;
 
-		while(endWindow < this->contigLength) {
-			totalCoverage = 0; //reset window coverage
-			for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].ReadCoverage;
-			}
-			meanCov = totalCoverage/(float)(endWindow - startWindow); // compute window coverage
-			if(meanCov > highCoverageFeat*C_A ) { // in the first window already present a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->highCoverageAreas.push_back(SS);
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
-			}
-		}
-		if(feat) { // a feature  reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->highCoverageAreas.push_back(SS);
-		}
-	}
+	compressionWindow(const WindowSums<InsertTrack> &insertSums, float insertionMean, float insertionStd, float Zscore) :
+		insertSums(insertSums), insertionMean(insertionMean), insertionStd(insertionStd), Zscore(Zscore) {}
 
+	bool operator()(unsigned int start, unsigned int end) {
+		return windowCEstats(insertSums, start, end, insertionMean, insertionStd) < Zscore;
+	}
+};
 
-	return features;
-}
+struct expansionWindow {
+	const WindowSums<InsertTrack> &insertSums;
+	float insertionMean;
+	float insertionStd;
+	float Zscore;
 
+	expansionWindow(const WindowSums<InsertTrack> &insertSums, float insertionMean, float insertionStd, float Zscore) :
+		insertSums(insertSums), insertionMean(insertionMean), insertionStd(insertionStd), Zscore(Zscore) {}
 
+	bool operator()(unsigned int start, unsigned int end) {
+		return windowCEstats(insertSums, start, end, insertionMean, insertionStd) > Zscore;
+	}
+};
 
 
-unsigned int Contig::getLowNormalAreas(float C_M, unsigned int windowSize, unsigned int windowStep) {
 
+unsigned int Contig::getLowCoverageAreas(float C_A, unsigned int windowSize, unsigned int windowStep) {
 	//compute length of low coverage areas in the contig
 	//use a 1K sliding window
-	unsigned int totalCoverageRead = 0;
-	unsigned int totalCoverage = 0;
-	unsigned int features = 0;
-	float meanCov, thr;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			totalCoverage += CONTIG[i].CorrectlyMated ;
-			totalCoverageRead += CONTIG[i].ReadCoverage ;
+	WindowSums<Track> readSums(tracks[readCov], this->contigLength, windowResolution(windowSize, windowStep));
+	lowCoverageWindow isFeature(readSums, lowCoverageFeat*C_A, MINUM_COV);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->lowCoverageAreas);
+}
 
-		}
-		meanCov = totalCoverage/(float)this->contigLength; // this is the "window" covrage
-		thr = totalCoverageRead/(float)this->contigLength;
-		if(meanCov < lowNormalFeat*C_M and thr > MINUM_COV ) { // this is a feature
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->lowNormalAreas.push_back(SS);
-			features = 1; // one feature found (in one window)
 
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		unsigned int winSize     = windowSize;
-		for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].CorrectlyMated;
-				totalCoverageRead += CONTIG[i].ReadCoverage ;
-		}
-		meanCov = totalCoverage/(float)winSize; // first window's covrage
-		thr = totalCoverageRead/(float)winSize;
-		if(meanCov < lowNormalFeat*C_M and thr > MINUM_COV) { // in the first window already present a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
-		}
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
+unsigned int  Contig::getHighCoverageAreas(float C_A, unsigned int windowSize, unsigned int windowStep) {
+	WindowSums<Track> readSums(tracks[readCov], this->contigLength, windowResolution(windowSize, windowStep));
+	highCoverageWindow isFeature(readSums, highCoverageFeat*C_A);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 0, this->highCoverageAreas);
+}
 
-		while(endWindow < this->contigLength) {
-			totalCoverage = 0; //reset window coverage
-			totalCoverageRead = 0;
-			for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].CorrectlyMated;
-				totalCoverageRead += CONTIG[i].ReadCoverage ;
-			}
-			meanCov = totalCoverage/(float)(endWindow - startWindow); // compute window coverage
-			thr = totalCoverageRead/(float)(endWindow - startWindow);
-
-			if(meanCov < lowNormalFeat*C_M and thr > MINUM_COV) { // in the first window already present a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->lowNormalAreas.push_back(SS);
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
-			}
-		}
-		if(feat) { // a feature reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->lowNormalAreas.push_back(SS);
-		}
-	}
 
-	return features;
+unsigned int Contig::getLowNormalAreas(float C_M, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int resolution = windowResolution(windowSize, windowStep);
+	WindowSums<Track> matedSums(tracks[cmCov], this->contigLength, resolution);
+	WindowSums<Track> readSums(tracks[readCov], this->contigLength, resolution);
+	lowNormalWindow isFeature(matedSums, readSums, lowNormalFeat*C_M, MINUM_COV);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->lowNormalAreas);
 }
 
 
-
 unsigned int Contig::getHighNormalAreas(float C_M, unsigned int windowSize, unsigned int windowStep) {
-
-	//compute length of low coverage areas in the contig
-	//use a 1K sliding window
-	unsigned int totalCoverage = 0;
-	unsigned int features = 0;
-	float meanCov;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			totalCoverage += CONTIG[i].CorrectlyMated ;
-		}
-		meanCov = totalCoverage/(float)this->contigLength; // this is the "window" covrage
-		if(meanCov > highNormalFeat*C_M ) { // this is a feature
-			features = 1; // one feature found (in one window)
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->highNormalAreas.push_back(SS);
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		unsigned int winSize     = windowSize;
-		for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].CorrectlyMated;
-		}
-		meanCov = totalCoverage/(float)winSize; // first window's covrage
-		if(meanCov > highNormalFeat*C_M ) {  // in the first window already present a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
-		}
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
-
-		while(endWindow < this->contigLength) {
-			totalCoverage = 0; //reset window coverage
-			for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].CorrectlyMated;
-			}
-			meanCov = totalCoverage/(float)(endWindow - startWindow); // compute window coverage
-			if(meanCov > highNormalFeat*C_M ) {  // in the first window already present a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->highNormalAreas.push_back(SS);
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
-			}
-		}
-		if(feat) { // a feature  reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->highNormalAreas.push_back(SS);
-		}
-	}
-	return features;
+	WindowSums<Track> matedSums(tracks[cmCov], this->contigLength, windowResolution(windowSize, windowStep));
+	highNormalWindow isFeature(matedSums, highNormalFeat*C_M);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->highNormalAreas);
 }
 
-unsigned int Contig::getHighSingleAreas( unsigned int windowSize, unsigned int windowStep, float C_A) {
-
-	unsigned int totalCoverage = 0;
-	unsigned int singleReadCoverage = 0;
-	unsigned int features = 0;
-	float meanTotalCov;
-	float meanSingleCov;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage ;
-			singleReadCoverage += CONTIG[i].Singleton;
-		}
-		meanTotalCov = totalCoverage/(float)this->contigLength; // this is the "window" total coverage
-		meanSingleCov = singleReadCoverage/(float)this->contigLength; // this is the "window" single read coverage
-		if( meanSingleCov > highSingleFeat*meanTotalCov and meanTotalCov > MINUM_COV ) { // this is a feature
-			features = 1; // one feature found (in one window)
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->highSingleAreas.push_back(SS);
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		unsigned int winSize     = windowSize;
-		for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage ;
-			singleReadCoverage += CONTIG[i].Singleton;
-		}
-		meanTotalCov = totalCoverage/(float)winSize; // this is the "window" total coverage
-		meanSingleCov = singleReadCoverage/(float)winSize; // this is the "window" single read coverage
-
-		if(meanTotalCov > 0.5 * C_A) {
-			if( meanSingleCov > highSingleFeat*meanTotalCov  and meanTotalCov > MINUM_COV ) { //first window's covrage
-				startFeat = 0;
-				endFeat = windowSize;
-				feat = true; // there is an open feature
-			}
-		}
-//		cout << feat << " " << meanTotalCov << " " << meanSingleCov << "\n";
-
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
-
-		while(endWindow < this->contigLength) {
-			totalCoverage = 0; //reset window coverage
-			singleReadCoverage = 0;
-			for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].ReadCoverage ;
-				singleReadCoverage += CONTIG[i].Singleton;
-			}
-			meanTotalCov = totalCoverage/(float)(endWindow - startWindow); // compute window total coverage
-			meanSingleCov = singleReadCoverage/(float)(endWindow - startWindow); // compute window single read coverage
-			if( meanSingleCov > highSingleFeat*meanTotalCov and meanTotalCov > MINUM_COV) {
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->highSingleAreas.push_back(SS);
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
-			}
-			//cout << feat << " " << startWindow << " " << meanTotalCov << " " << meanSingleCov << "\n";
-		}
-		if(feat) { // a feature  reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->highSingleAreas.push_back(SS);
-		}
-	}
-	return features;
 
+unsigned int Contig::getHighSingleAreas( unsigned int windowSize, unsigned int windowStep, float C_A) {
+	unsigned int resolution = windowResolution(windowSize, windowStep);
+	WindowSums<Track> singleSums(tracks[singCov], this->contigLength, resolution);
+	WindowSums<Track> readSums(tracks[readCov], this->contigLength, resolution);
+	highSingleWindow isFeature(singleSums, readSums, highSingleFeat, MINUM_COV, windowSize, C_A);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->highSingleAreas);
 }
 
 
-
 unsigned int Contig::getHighSpanningAreas( unsigned int windowSize, unsigned int windowStep, float C_A ) {
-
-	unsigned int totalCoverage = 0;
-	unsigned int matedDifferentContigCoverage = 0;
-	unsigned int features = 0;
-	float meanTotalCov;
-	float meanMatedDifferentContigCoverage;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage ;
-			matedDifferentContigCoverage += CONTIG[i].MatedDifferentContig;
-		}
-		meanTotalCov = totalCoverage/(float)this->contigLength; // this is the "window" total coverage
-		meanMatedDifferentContigCoverage = matedDifferentContigCoverage/(float)this->contigLength; // this is the "window" single read coverage
-		if( meanMatedDifferentContigCoverage > highSpanningFeat*meanTotalCov  and meanTotalCov > MINUM_COV ) { // this is a feature
-			features = 1; // one feature found (in one window)
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->highSpanningAreas.push_back(SS);
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		unsigned int winSize     = windowSize;
-		for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage ;
-			matedDifferentContigCoverage += CONTIG[i].MatedDifferentContig;
-		}
-		meanTotalCov = totalCoverage/(float)winSize; //
-		meanMatedDifferentContigCoverage = matedDifferentContigCoverage/(float)winSize; //
-		if( meanMatedDifferentContigCoverage > highSpanningFeat*meanTotalCov  and meanTotalCov > MINUM_COV ) { // this is a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
-		}
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
-
-		while(endWindow < this->contigLength) {
-			totalCoverage = 0; //reset window coverage
-			matedDifferentContigCoverage = 0;
-			for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].ReadCoverage ;
-				matedDifferentContigCoverage += CONTIG[i].MatedDifferentContig;
-			}
-			meanTotalCov = totalCoverage/(float)(endWindow - startWindow); // compute window total coverage
-			meanMatedDifferentContigCoverage = matedDifferentContigCoverage/(float)(endWindow - startWindow); // compute window single read coverage
-			if( meanMatedDifferentContigCoverage > highSpanningFeat*meanTotalCov  and meanTotalCov > MINUM_COV) { // this is a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->highSpanningAreas.push_back(SS);
-
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
-			}
-		}
-		if(feat) { // a feature  reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->highSpanningAreas.push_back(SS);
-		}
-	}
-
-	return features;
-
-
+	unsigned int resolution = windowResolution(windowSize, windowStep);
+	WindowSums<Track> matedDifferentContigSums(tracks[mdcCov], this->contigLength, resolution);
+	WindowSums<Track> readSums(tracks[readCov], this->contigLength, resolution);
+	highFractionWindow isFeature(matedDifferentContigSums, readSums, highSpanningFeat, MINUM_COV);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->highSpanningAreas);
 }
 
 
-
 unsigned int Contig::getHighOutieAreas( unsigned int windowSize, unsigned int windowStep, float C_A ) {
-	unsigned int totalCoverage = 0;
-	unsigned int outieCoverage = 0;
-	unsigned int features = 0;
-	float meanTotalCov;
-	float meanOutieCoverage;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage ;
-			outieCoverage += CONTIG[i].WronglyOriented;
-		}
-		meanTotalCov = totalCoverage/(float)this->contigLength; // this is the "window" total coverage
-		meanOutieCoverage = outieCoverage/(float)this->contigLength; // this is the "window" single read coverage
-		if( meanOutieCoverage > highOutieFeat*meanTotalCov  and meanTotalCov > MINUM_COV) { // this is a feature
-			features = 1; // one feature found (in one window)
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->highOutieAreas.push_back(SS);
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		unsigned int winSize     = windowSize;
-		for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-			totalCoverage += CONTIG[i].ReadCoverage ;
-			outieCoverage +=  (CONTIG[i].WronglyOriented);
-		}
-		meanTotalCov = totalCoverage/(float)winSize; //
-		meanOutieCoverage = outieCoverage/(float)winSize; //
-		if(  meanOutieCoverage > highOutieFeat*meanTotalCov   and meanTotalCov > MINUM_COV) { // this is a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
-		}
-
-
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
-
-		while(endWindow < this->contigLength) {
-			meanTotalCov = 0;
-			meanOutieCoverage = 0;
-			totalCoverage = 0;
-			outieCoverage = 0;
-			for(unsigned int i=startWindow; i < endWindow ; i++ ) {
-				totalCoverage += CONTIG[i].ReadCoverage ;
-				outieCoverage += CONTIG[i].WronglyOriented;
-			}
-			meanTotalCov = totalCoverage/(float)(endWindow - startWindow); // compute window total coverage
-			meanOutieCoverage = outieCoverage/(float)(endWindow - startWindow); // compute window single read coverage
-			if(  meanOutieCoverage > highOutieFeat*meanTotalCov   and meanTotalCov > MINUM_COV) { // this is a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->highOutieAreas.push_back(SS);
-
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
-			}
-		}
-		if(feat) { // a feature  reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->highOutieAreas.push_back(SS);
-		}
-	}
-	return features;
-
+	unsigned int resolution = windowResolution(windowSize, windowStep);
+	WindowSums<Track> outieSums(tracks[woCov], this->contigLength, resolution);
+	WindowSums<Track> readSums(tracks[readCov], this->contigLength, resolution);
+	highFractionWindow isFeature(outieSums, readSums, highOutieFeat, MINUM_COV);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->highOutieAreas);
 }
 
 
-
-
 unsigned int Contig::getCompressionAreas(float insertionMean, float insertionStd, float Zscore, unsigned int windowSize, unsigned int windowStep) {
+	WindowSums<InsertTrack> insertSums(this->inserts, this->contigLength, windowResolution(windowSize, windowStep));
+	compressionWindow isFeature(insertSums, insertionMean, insertionStd, Zscore);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->compressionAreas);
+}
 
-	unsigned long int spanningCoverage = 0; // total insert length
-	unsigned int inserts = 0; // number of inserts
-	unsigned int features = 0;
-	float Z_stats;
-	float localMean;
-	unsigned int minInsertNum = 5;
-
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			if(CONTIG[i].StratingInserts > 0) {
-				inserts += CONTIG[i].StratingInserts;
-				spanningCoverage += CONTIG[i].insertsLength;
-			}
-		}
-		if(inserts > minInsertNum) {
-			localMean = spanningCoverage/(float)inserts;
-			Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-		} else {
-			Z_stats = 0;
-		}
-		if( Z_stats <  Zscore ) { // this is a feature
-			features = 1; // one feature found (in one window)
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->compressionAreas.push_back(SS);
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		for(unsigned int i=startWindow; i < endWindow; i++ ) {
-			if(CONTIG[i].StratingInserts > 0) {
-				inserts += CONTIG[i].StratingInserts;
-				spanningCoverage += CONTIG[i].insertsLength;
-			}
-		}
-		if(inserts > minInsertNum) {
-			localMean = spanningCoverage/(float)inserts;
-			Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-		} else {
-			Z_stats = 0;
-		}
-
-		//cout << feat << " " << startWindow << " " << Z_stats << " " << inserts << " " << insertionMean << " " << insertionStd << " " << localMean << " " << localMean - insertionMean << "\n";
-
-		if( Z_stats <  Zscore ) { // this is a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
-		}
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
-		}
-
-		while(endWindow < this->contigLength) {
-			inserts = 0; //reset window coverage
-			spanningCoverage = 0;
-			for(unsigned int i=startWindow; i < endWindow; i++ ) {
-				if(CONTIG[i].StratingInserts > 0) {
-					inserts += CONTIG[i].StratingInserts;
-					spanningCoverage += CONTIG[i].insertsLength;
-				}
-			}
-			if(inserts > minInsertNum) {
-				localMean = spanningCoverage/(float)inserts;
-				Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-			} else {
-				Z_stats = 0;
-			}
-
-			//cout << feat << " " << startWindow << " " << Z_stats << " " << inserts << " " << insertionMean << " " << insertionStd << " " << localMean << " " << localMean - insertionMean << "\n";
-			if( Z_stats <  Zscore ) { // this is a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->compressionAreas.push_back(SS);
-
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
-			}
-		}
-		if(feat) { // a feature  reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->compressionAreas.push_back(SS);
-		}
-	}
-
-	return features;
 
+unsigned int Contig::getExpansionAreas(float insertionMean, float insertionStd, float Zscore, unsigned int windowSize, unsigned int windowStep) {
+	WindowSums<InsertTrack> insertSums(this->inserts, this->contigLength, windowResolution(windowSize, windowStep));
+	expansionWindow isFeature(insertSums, insertionMean, insertionStd, Zscore);
+	return slideWindow(this->contigLength, windowSize, windowStep, isFeature, 1, this->expansionAreas);
 }
 
 
-unsigned int Contig::getExpansionAreas(float insertionMean, float insertionStd, float Zscore, unsigned int windowSize, unsigned int windowStep) {
-	unsigned long int spanningCoverage = 0; // total insert length
-	unsigned int inserts = 0; // number of inserts
-	unsigned int features = 0;
-	float localMean;
-	float Z_stats = 0;
-	unsigned int minInsertNum = 5;
-	if(this->contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < this->contigLength ; i++ ) {
-			if(CONTIG[i].StratingInserts > 0) {
-				inserts += CONTIG[i].StratingInserts;
-				spanningCoverage += CONTIG[i].insertsLength;
-			}
-		}
-		if(inserts > minInsertNum) {
-			localMean = spanningCoverage/(float)inserts;
-			Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-		} else {
-			Z_stats = 0;
-		}
-		if( Z_stats >  Zscore ) { // this is a feature
-			features = 1; // one feature found (in one window)
-			pair<unsigned int , unsigned int > SS (0, this->contigLength);
-			this->expansionAreas.push_back(SS);
-		}
-	} else { //otherwise compute features on sliding window of 200 bp
-		unsigned int startFeat, endFeat;
-		bool feat = false;
-		unsigned int startWindow = 0;
-		unsigned int endWindow   = windowSize;
-		for(unsigned int i=startWindow; i < endWindow; i++ ) {
-			if(CONTIG[i].StratingInserts > 0) {
-				inserts += CONTIG[i].StratingInserts;
-				spanningCoverage += CONTIG[i].insertsLength;
-			}
-		}
-		if(inserts > minInsertNum) {
-			localMean = spanningCoverage/(float)inserts;
-			Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-		} else {
-			Z_stats = 0;
-		}
-		if( Z_stats > Zscore ) { // this is a feature
-			startFeat = 0;
-			endFeat = windowSize;
-			feat = true; // there is an open feature
-		}
-	//	cout << feat << " " << startWindow << " " << Z_stats << " " << inserts << " " << insertionMean << " " << insertionStd << " " << localMean << " " << localMean - insertionMean << "\n";
-		//now update
-		startWindow += windowStep;
-		endWindow += windowStep;
-		if(endWindow > this->contigLength) {
-			endWindow = this->contigLength;
+/*
+ * The cumulative sums of the tracks are built block by block in a single walk over the contig and every detector
+ * inspects its windows as soon as the blocks covering them are summed. Inserts are sparse, their sums do not need the walk.
+ */
+void Contig::computeAreas(bool is_mp, float C_A, float C_M, float insertionMean, float insertionStd, float CE_min, float CE_max,
+		unsigned int windowSize, unsigned int windowStep, unsigned int CEwindowSize, unsigned int CEwindowStep,
+		unsigned int features[TOTAL], vector<float> &CEvalues) {
+	unsigned int resolution = windowResolution(windowSize, windowStep);
+	WindowSums<Track> sums[COV_TYPES];
+	for(unsigned int type = 0; type < COV_TYPES; type++) {
+		if(trackMask & TRACK(type)) {
+			sums[type].start(tracks[type], this->contigLength, resolution);
 		}
-
-		while(endWindow < this->contigLength) {
-			inserts = 0; //reset window coverage
-			spanningCoverage = 0;
-			for(unsigned int i=startWindow; i < endWindow; i++ ) {
-				if(CONTIG[i].StratingInserts > 0) {
-					inserts += CONTIG[i].StratingInserts;
-					spanningCoverage += CONTIG[i].insertsLength;
-				}
-			}
-			if(inserts > minInsertNum) {
-				localMean = spanningCoverage/(float)inserts;
-				Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-			} else {
-				Z_stats = 0;
-			}
-			if( Z_stats > Zscore ) { // this is a feature
-				if(feat) { // if we are already inside a feature area
-					endFeat = endWindow; // simply extend the feature area
-				} else {
-					startFeat = startWindow;
-					endFeat = endWindow;
-					feat = true; // open feature area
-				}
-				startWindow += windowStep;
-				endWindow += windowStep;
-				if(endWindow > this->contigLength) {
-					endWindow = this->contigLength;
-				}
-			} else { // this window is not affected by feature
-				if(feat) { // if before a
-					features += floor((endFeat - startFeat + 1)/(float)windowSize + 0.5) ; // compute number of features
-					pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-					this->expansionAreas.push_back(SS);
-
-					startWindow = endWindow;
-					endWindow = startWindow + windowSize;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-					feat = false; //close feature area
-				} else { // no feature was present in the window before
-					startWindow += windowStep;
-					endWindow += windowStep;
-					if(endWindow > this->contigLength) {
-						endWindow = this->contigLength;
-					}
-				}
+	}
+	WindowSums<InsertTrack> insertSums(this->inserts, this->contigLength, windowResolution(CEwindowSize, CEwindowStep));
+
+	lowCoverageWindow  lowCoverage(sums[readCov], lowCoverageFeat*C_A, MINUM_COV);
+	highCoverageWindow highCoverage(sums[readCov], highCoverageFeat*C_A);
+	lowNormalWindow    lowNormal(sums[cmCov], sums[readCov], lowNormalFeat*C_M, MINUM_COV);
+	highNormalWindow   highNormal(sums[cmCov], highNormalFeat*C_M);
+	highSingleWindow   highSingle(sums[singCov], sums[readCov], highSingleFeat, MINUM_COV, windowSize, C_A);
+	highFractionWindow highOutie(sums[woCov], sums[readCov], highOutieFeat, MINUM_COV);
+	highFractionWindow highSpanning(sums[mdcCov], sums[readCov], highSpanningFeat, MINUM_COV);
+	compressionWindow  compression(insertSums, insertionMean, insertionStd, CE_min);
+	expansionWindow    expansion(insertSums, insertionMean, insertionStd, CE_max);
+	CEwindow           CEstats(insertSums, insertionMean, insertionStd, CEvalues);
+
+	WindowScanner<lowCoverageWindow>  lowCoverageScanner(this->contigLength, windowSize, windowStep, lowCoverage, 1, this->lowCoverageAreas);
+	WindowScanner<highCoverageWindow> highCoverageScanner(this->contigLength, windowSize, windowStep, highCoverage, 0, this->highCoverageAreas);
+	WindowScanner<lowNormalWindow>    lowNormalScanner(this->contigLength, windowSize, windowStep, lowNormal, 1, this->lowNormalAreas);
+	WindowScanner<highNormalWindow>   highNormalScanner(this->contigLength, windowSize, windowStep, highNormal, 1, this->highNormalAreas);
+	WindowScanner<highSingleWindow>   highSingleScanner(this->contigLength, windowSize, windowStep, highSingle, 1, this->highSingleAreas);
+	WindowScanner<highFractionWindow> highOutieScanner(this->contigLength, windowSize, windowStep, highOutie, 1, this->highOutieAreas);
+	WindowScanner<highFractionWindow> highSpanningScanner(this->contigLength, windowSize, windowStep, highSpanning, 1, this->highSpanningAreas);
+
+	unsigned int swept = 0; // tracks on disk are dropped from memory behind the windows
+	for(unsigned int blockStart = 0; blockStart < this->contigLength; blockStart += resolution) {
+		unsigned int blockEnd = blockStart + resolution < this->contigLength ? blockStart + resolution : this->contigLength;
+		if(tracksOnDisk and blockStart >= swept + windowSize + TRIM_BASES) {
+			trimTracks(swept, blockStart - windowSize);
+			swept = blockStart - windowSize;
+		}
+		for(unsigned int type = 0; type < COV_TYPES; type++) {
+			if(trackMask & TRACK(type)) {
+				sums[type].addBlock(tracks[type].sum(blockStart, blockEnd));
 			}
-	//		cout << feat << " " << startWindow << " " << Z_stats << " " << inserts << " " << insertionMean << " " << insertionStd << " " << localMean << " " << localMean - insertionMean << "\n";
 		}
-		//compute last window statistics
-
-		if(feat) { // a feature reached contig end
-			features +=   floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
-			pair<unsigned int , unsigned int > SS (startFeat, endFeat);
-			this->expansionAreas.push_back(SS);
+		if(!is_mp) {
+			lowCoverageScanner.advance(blockEnd);
+			highCoverageScanner.advance(blockEnd);
+			lowNormalScanner.advance(blockEnd);
+			highNormalScanner.advance(blockEnd);
 		}
+		highSingleScanner.advance(blockEnd);
+		highOutieScanner.advance(blockEnd);
+		highSpanningScanner.advance(blockEnd);
 	}
-	return features;
 
+	for(unsigned int feature = 0; feature < TOTAL; feature++) {
+		features[feature] = 0;
+	}
+	if(!is_mp) {
+		features[LOW_COVERAGE_AREA]  = lowCoverageScanner.finish();
+		features[HIGH_COVERAGE_AREA] = highCoverageScanner.finish();
+		features[LOW_NORMAL_AREA]    = lowNormalScanner.finish();
+		features[HIGH_NORMAL_AREA]   = highNormalScanner.finish();
+	}
+	features[HIGH_SINGLE_AREA]   = highSingleScanner.finish();
+	features[HIGH_OUTIE_AREA]    = highOutieScanner.finish();
+	features[HIGH_SPANNING_AREA] = highSpanningScanner.finish();
+	features[COMPRESSION_AREA]   = slideWindow(this->contigLength, CEwindowSize, CEwindowStep, compression, 1, this->compressionAreas);
+	features[STRECH_AREA]        = slideWindow(this->contigLength, CEwindowSize, CEwindowStep, expansion, 1, this->expansionAreas);
+
+	vector<pair<unsigned int, unsigned int> > noAreas;
+	slideWindow(this->contigLength, CEwindowSize, CEwindowStep, CEstats, 0, noAreas);
 }
-
-
-
@@ -16,6 +16,8 @@
 #include <iostream>
 #include "common.h"
 #include "Features.h"
+#include "Track.h"
+#include "Window.h"
 //using namespace BamTools;
 
 
@@ -30,24 +32,15 @@ public:
 };
 
 
-enum data {readCov, insertCov, cmCov, woCov, singCov, mdcCov};
+enum covType {readCov, insertCov, cmCov, woCov, singCov, mdcCov, COV_TYPES};
 
-class Position {
-public:
-	unsigned int ReadCoverage;
-	unsigned int StratingInserts;
-	unsigned int InsertCoverage;
-	unsigned int CorrectlyMated;
-	unsigned int WronglyOriented;
-	unsigned int Singleton;
-	unsigned int MatedDifferentContig;
-	unsigned long int insertsLength;
-
-	Position();
+// tracks kept base by base, the other ones only keep their total
+#define TRACK(type) (1 << (type))
+#define PE_TRACKS (TRACK(readCov) | TRACK(cmCov) | TRACK(woCov) | TRACK(singCov) | TRACK(mdcCov))
+#define MP_TRACKS (TRACK(readCov) | TRACK(woCov) | TRACK(singCov) | TRACK(mdcCov))
 
-	~Position();
 
-};
+#define TRIM_BASES (1 << 22) // bases swept between two trims of the tracks on disk
 
 
 #define MIN(x,y) \
@@ -72,17 +65,32 @@ class Contig{
 	float MINUM_COV;
 	string contigID;
 
-	void updateCov(unsigned int strat, unsigned int end, data type);
+	unsigned int trackMask;
+	unsigned int binSize; // bases summed in each track counter, 1 keeps single base resolution
+	Track tracks[COV_TYPES]; // per base values of the tracks in trackMask
+	unsigned int coverageTotal[COV_TYPES]; // sum over the contig of every track
+	InsertTrack inserts; // inserts starting on the contig, sorted by position once the contig is finalized
+	bool tracksOnDisk;    // some track is mapped from a file (see TrackArena): it is dropped from memory behind the sweeps
+	unsigned int trimmed; // bases before it are dropped while the alignments (sorted by position) are added
 
-public:
-	Position *CONTIG;
+	void allocateTracks(unsigned int trackMask);
+	void trimTracks(unsigned int start, unsigned int end);
+	void updateCov(unsigned int strat, unsigned int end, covType type);
 
+public:
 	Contig();
 	Contig(unsigned int contigLength);
-	Contig(string contigID, unsigned int contigLength);
+	Contig(string contigID, unsigned int contigLength, unsigned int trackMask = PE_TRACKS, unsigned int binSize = 1);
 	~Contig();
 
-	void updateContig(BamAlignment b, int max_insert,  bool is_mp); // given an alignment it updates the contig situation
+	void reset(string contigID, unsigned int contigLength, unsigned int trackMask = PE_TRACKS, unsigned int binSize = 1); // reuse the contig (and its memory) for another sequence
+
+	void updateContig(const alignmentCore &b, int max_insert,  bool is_mp); // given an alignment it updates the contig situation
+	void finalize(); // turns the +1/-1 events recorded by updateContig into per-base values, must be called before reading the tracks
+
+	bool hasTrack(covType type);
+	const Track & getTrack(covType type);
+	const InsertTrack & getInserts();
 
 	float getCoverage();
 
@@ -98,8 +106,16 @@ public:
 	unsigned int getCompressionAreas(float insertionMean, float insertionStd, float Zscore, unsigned int windowSize, unsigned int windowStep);
 	unsigned int getExpansionAreas(float insertionMean, float insertionStd, float Zscore, unsigned int windowSize, unsigned int windowStep);
 
+	// all the areas of a library (only the mate pair ones if is_mp) and the CE statistics of the CE windows in a single sweep over the tracks
+	void computeAreas(bool is_mp, float C_A, float C_M, float insertionMean, float insertionStd, float CE_min, float CE_max,
+			unsigned int windowSize, unsigned int windowStep, unsigned int CEwindowSize, unsigned int CEwindowStep,
+			unsigned int features[TOTAL], vector<float> &CEvalues);
+
 	void print();
-	void printContigMetrics(ofstream &ContigsMetricsFile);
+	void printContigMetrics(TextWriter &ContigsMetricsFile);
+
+	void writeSummary(FILE *file); // stores a finalized contig: id, totals, tracks and inserts
+	bool readSummary(FILE *file); // loads a contig stored by writeSummary() reusing the memory of this one
 
 
 
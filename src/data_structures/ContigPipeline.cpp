@@ -0,0 +1,156 @@
+#include "ContigPipeline.h"
+#include <sstream>
+#include <cstdio>
+#include <boost/thread/thread.hpp>
+#include <boost/bind/bind.hpp>
+#include "RunReport.h"
+
+
+ContigPipeline::ContigPipeline(FRC &frc, string library, bool is_mp, int max_insert, float CE_min, float CE_max, unsigned int CEwindow, unsigned int binSize,
+		map<unsigned int, string> &position2contig, TextWriter &ContigMetricsFile, unsigned int threads) :
+		frc(frc), library(library), position2contig(position2contig), ContigMetricsFile(ContigMetricsFile),
+		fullBatches(BATCHES), emptyBatches(BATCHES), readyJobs(threads + 2), freeJobs(threads + 2) {
+	this->type       = is_mp ? "MP" : "PE";
+	this->is_mp      = is_mp;
+	this->max_insert = max_insert;
+	this->CE_min     = CE_min;
+	this->CE_max     = CE_max;
+	this->CEwindow   = CEwindow;
+	this->binSize    = binSize;
+	this->workers    = threads > 2 ? threads - 2 : 1; // one thread reads, one builds the tracks
+	this->nextCommit = 0;
+
+	for(unsigned int i = 0; i < BATCHES; i++) {
+		vector<alignmentCore> *batch = new vector<alignmentCore>();
+		batch->reserve(BATCH_SIZE);
+		emptyBatches.push(batch);
+	}
+	unsigned int tracks = is_mp ? MP_TRACKS : PE_TRACKS;
+	for(unsigned int i = 0; i < this->workers + 2; i++) { // every worker busy and the builder filling one more
+		contigJob *job = new contigJob();
+		job->contig = new Contig("", 0, tracks, binSize);
+		freeJobs.push(job);
+	}
+}
+
+
+ContigPipeline::~ContigPipeline() {
+	vector<alignmentCore> *batch;
+	emptyBatches.close();
+	while(emptyBatches.pop(batch)) {
+		delete batch;
+	}
+	contigJob *job;
+	freeJobs.close();
+	while(freeJobs.pop(job)) {
+		delete job->contig;
+		delete job;
+	}
+}
+
+
+void ContigPipeline::readAlignments(AlignmentReader *bamFile) {
+	PhaseClock clock;
+	alignmentCore al;
+	vector<alignmentCore> *batch;
+	emptyBatches.pop(batch);
+	clock.restart();
+	while ( bamFile->GetNextAlignmentCore(al) ) {
+		batch->push_back(al);
+		if(batch->size() == BATCH_SIZE) {
+			clock.lap(PHASE_DECODE, batch->size());
+			fullBatches.push(batch);
+			emptyBatches.pop(batch);
+			clock.restart();
+		}
+	}
+	clock.lap(PHASE_DECODE, batch->size());
+	if(batch->empty()) {
+		emptyBatches.push(batch);
+	} else {
+		fullBatches.push(batch);
+	}
+	fullBatches.close();
+}
+
+
+void ContigPipeline::processContigs() {
+	PhaseClock clock;
+	contigJob *job;
+	while(readyJobs.pop(job)) {
+		clock.restart();
+		Contig *contig = job->contig;
+		contig->finalize();
+		TextWriter metrics;
+		contig->printContigMetrics(metrics);
+		frc.detectFeatures(type, contig, 1000, 200, CE_min, CE_max, CEwindow, CEwindow, job->features, job->CEvalues);
+		clock.lap(PHASE_FEATURES);
+		if(RunReport::enabled()) { // from the first alignment of the contig
+			RunReport::addContig(library, position2contig.find(job->ctg)->second, contig->getContigLength(), RunReport::now() - job->started);
+		}
+
+		// results are stored in reading order
+		boost::unique_lock<boost::mutex> guard(commitLock);
+		while(job->sequence != nextCommit) {
+			committed.wait(guard);
+		}
+		ContigMetricsFile << metrics.str();
+		frc.addFeatures(type, job->ctg, contig, job->features, job->CEvalues);
+		nextCommit++;
+		committed.notify_all();
+		guard.unlock();
+
+		job->CEvalues.clear();
+		freeJobs.push(job);
+	}
+}
+
+
+void ContigPipeline::run(AlignmentReader &bamFile) {
+	boost::thread reader(boost::bind(&ContigPipeline::readAlignments, this, &bamFile));
+	boost::thread_group pool;
+	for(unsigned int i = 0; i < workers; i++) {
+		pool.create_thread(boost::bind(&ContigPipeline::processContigs, this));
+	}
+
+	PhaseClock clock;
+	contigJob *job = NULL;
+	int currentContig = -1;
+	unsigned long int sequence = 0;
+	vector<alignmentCore> *batch;
+	while(fullBatches.pop(batch)) {
+		clock.restart();
+		for(unsigned int i = 0; i < batch->size(); i++) {
+			const alignmentCore &al = (*batch)[i];
+			if (!al.IsMapped()) {
+				continue;
+			}
+			if (al.RefID != currentContig) { // another contig or simply the first one
+				if(job != NULL) {
+					readyJobs.push(job); // the old contig is complete
+				}
+				freeJobs.pop(job); // wait for a contig to be free
+				uint32_t contigSize = frc.getContigLength(al.RefID);
+				if (contigSize < 1 and currentContig != -1) {//We can't have such sizes! this can't be right
+					fprintf(stderr,"%d has size %d, which can't be right!\nCheck bam header!",al.RefID,contigSize);
+				}
+				currentContig = al.RefID;
+				job->contig->reset(position2contig[currentContig], contigSize, is_mp ? MP_TRACKS : PE_TRACKS, binSize);
+				job->ctg      = currentContig;
+				job->sequence = sequence++;
+				job->started  = RunReport::enabled() ? RunReport::now() : 0;
+			}
+			job->contig->updateContig(al, max_insert, is_mp);
+		}
+		clock.lap(PHASE_TRACKS, batch->size());
+		batch->clear();
+		emptyBatches.push(batch);
+	}
+	if(job != NULL) {
+		readyJobs.push(job);
+	}
+	readyJobs.close();
+
+	pool.join_all();
+	reader.join();
+}
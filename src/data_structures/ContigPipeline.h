@@ -0,0 +1,73 @@
+#ifndef CONTIGPIPELINE_H_
+#define CONTIGPIPELINE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+#include "FRC.h"
+#include "BoundedQueue.h"
+
+using namespace std;
+
+
+// a contig travelling through the pipeline, with the results of its feature detection
+struct contigJob {
+	Contig *contig;
+	unsigned int ctg;
+	unsigned long int sequence; // order in which the contig was read
+	double started;             // when its first alignment was added (see RunReport)
+	unsigned int features[TOTAL];
+	vector<float> CEvalues;
+};
+
+
+/*
+ * Pipelined version of the computeFRC contig loop:
+ *  - a reader thread decodes the alignments into batches of alignmentCore,
+ *  - the calling thread adds them to the tracks of the current contig,
+ *  - a pool of workers finalizes the finished contigs and runs the window detectors and the CE statistics.
+ * Stages are connected by bounded queues: at most a fixed number of batches and of contigs are alive.
+ * Workers store their results in the FRC (and the contig table) in reading order, so the output is
+ * the same of the serial loop.
+ */
+class ContigPipeline {
+	FRC &frc;
+	string library;
+	string type; // PE or MP
+	bool is_mp;
+	int max_insert;
+	float CE_min;
+	float CE_max;
+	unsigned int CEwindow;
+	unsigned int binSize;
+	map<unsigned int, string> &position2contig;
+	TextWriter &ContigMetricsFile;
+	unsigned int workers;
+
+	static const unsigned int BATCH_SIZE = 4096;
+	static const unsigned int BATCHES    = 8;
+
+	BoundedQueue<vector<alignmentCore> *> fullBatches;
+	BoundedQueue<vector<alignmentCore> *> emptyBatches;
+	BoundedQueue<contigJob *> readyJobs;
+	BoundedQueue<contigJob *> freeJobs;
+
+	boost::mutex commitLock;
+	boost::condition_variable committed;
+	unsigned long int nextCommit;
+
+	void readAlignments(AlignmentReader *bamFile);
+	void processContigs();
+
+public:
+	ContigPipeline(FRC &frc, string library, bool is_mp, int max_insert, float CE_min, float CE_max, unsigned int CEwindow, unsigned int binSize,
+			map<unsigned int, string> &position2contig, TextWriter &ContigMetricsFile, unsigned int threads);
+	~ContigPipeline();
+
+	void run(AlignmentReader &bamFile); // process all the alignments of an open BAM or SAM file
+};
+
+
+#endif /* CONTIGPIPELINE_H_ */
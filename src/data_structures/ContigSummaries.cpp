@@ -0,0 +1,96 @@
+#include "ContigSummaries.h"
+
+
+ContigSummaries::ContigSummaries(string fileName) {
+	this->contigs = 0;
+	spill = fopen(fileName.c_str(), "w+b");
+	if(spill == NULL) {
+		cerr << "cannot open " << fileName << " to store the contigs\n";
+		exit(2);
+	}
+	remove(fileName.c_str());
+}
+
+ContigSummaries::~ContigSummaries() {
+	fclose(spill);
+}
+
+
+bool ContigSummaries::add(unsigned int ctg, Contig &contig) {
+	fwrite(&ctg, sizeof(ctg), 1, spill);
+	contig.writeSummary(spill);
+	contigs++;
+	return !ferror(spill);
+}
+
+void ContigSummaries::rewind() {
+	fflush(spill);
+	fseek(spill, 0, SEEK_SET);
+}
+
+bool ContigSummaries::next(unsigned int &ctg, Contig &contig) {
+	if(fread(&ctg, sizeof(ctg), 1, spill) != 1) {
+		return false;
+	}
+	return contig.readSummary(spill);
+}
+
+unsigned int ContigSummaries::size() {
+	return contigs;
+}
+
+
+
+LibraryStatistics computeLibraryStatsSinglePass(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp, unsigned int binSize,
+		unsigned int readAhead, ContigSummaries &summaries, libraryCounts *countsOut) {
+	AlignmentReader bamFile;
+	bamFile.SetReadAhead(readAhead);
+	bamFile.Open(bamFileName);
+	RefVector references = bamFile.GetReferenceData();
+	libraryCounts counts;
+
+	unsigned int tracks = is_mp ? MP_TRACKS : PE_TRACKS;
+	unsigned int bin    = binSize > 1 ? binSize : windowResolution(1000, 200);
+	Contig contig("", 0, tracks, bin);
+	int currentContig = -1;
+
+	alignmentCore al;
+	while ( bamFile.GetNextAlignmentCore(al) ) {
+		counts.add(al, max_insert, is_mp);
+		if (!al.IsMapped()) {
+			continue;
+		}
+		if (al.RefID != currentContig) { // another contig or simply the first one
+			if(currentContig != -1) {
+				contig.finalize();
+				if(!summaries.add(currentContig, contig)) {
+					cerr << "error while storing the contigs of " << bamFileName << "\n";
+					exit(2);
+				}
+			}
+			uint32_t contigSize = references[al.RefID].RefLength;
+			if (contigSize < 1 and currentContig != -1) {//We can't have such sizes! this can't be right
+				fprintf(stderr,"%d has size %d, which can't be right!\nCheck bam header!",al.RefID,contigSize);
+			}
+			currentContig = al.RefID;
+			contig.reset(references[currentContig].RefName, contigSize, tracks, bin);
+		}
+		contig.updateContig(al, max_insert, is_mp);
+	}
+	if(currentContig != -1) {
+		contig.finalize();
+		if(!summaries.add(currentContig, contig)) {
+			cerr << "error while storing the contigs of " << bamFileName << "\n";
+			exit(2);
+		}
+	}
+
+	LibraryStatistics library = counts.statistics(genomeLength);
+	library.library_name = libraryName(bamFileName);
+	if(countsOut != NULL) {
+		*countsOut = counts;
+	}
+
+	bamFile.Close();
+	return library;
+}
@@ -0,0 +1,44 @@
+#ifndef CONTIGSUMMARIES_H_
+#define CONTIGSUMMARIES_H_
+
+#include <string>
+#include <cstdio>
+
+#include "Contig.h"
+
+using namespace std;
+
+
+/*
+ * Finalized contigs (totals, binned tracks and inserts) stored on disk while the library statistics are still unknown.
+ * The contigs are read back in the order they were added, when the features can be computed.
+ */
+class ContigSummaries {
+	FILE *spill; // removed as soon as it is opened, it disappears when closed
+	unsigned int contigs;
+
+	ContigSummaries(const ContigSummaries &);
+	ContigSummaries & operator=(const ContigSummaries &);
+
+public:
+	ContigSummaries(string fileName);
+	~ContigSummaries();
+
+	bool add(unsigned int ctg, Contig &contig); // contig must be finalized
+	void rewind();
+	bool next(unsigned int &ctg, Contig &contig);
+	unsigned int size();
+};
+
+
+/*
+ * Single pass version of computeLibraryStats: while the library counts are collected every contig is built as in
+ * computeFRC and stored in summaries, so that the BAM file is read only once. Library statistics are the same of
+ * computeLibraryStats. Tracks are kept in bins of binSize bases, or of the window grid when binSize is 1, since
+ * the windows only look at sums over the grid. If countsOut is given it is filled with the library counts.
+ */
+LibraryStatistics computeLibraryStatsSinglePass(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp, unsigned int binSize,
+		unsigned int readAhead, ContigSummaries &summaries, libraryCounts *countsOut = NULL);
+
+
+#endif /* CONTIGSUMMARIES_H_ */
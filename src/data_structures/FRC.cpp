@@ -8,12 +8,8 @@
 #include "FRC.h"
 #include <fstream>
 
-bool sortContigs(contigFeatures i, contigFeatures j) {
-	return (i.getContigLength() > j.getContigLength());
-}
-
 FRC::FRC() {
-
+	this->library = 0;
 }
 
 FRC::~FRC() {
@@ -25,11 +21,29 @@ FRC::~FRC() {
 FRC::FRC(unsigned int contigs) {
 	this->contigs = contigs;
 	this->CONTIG.resize(contigs);
+	this->library = 0;
+}
+
+
+void FRC::setLibrary(unsigned int library) {
+	this->library = library;
 }
 
 
-void FRC::sortFRC() {
-	sort(CONTIG.begin(), CONTIG.end(), sortContigs);
+void FRC::mergeFeatures(const FRC &other) {
+	for(unsigned int ctg = 0; ctg < this->contigs; ctg++) {
+		this->CONTIG[ctg].mergeFeatures(other.CONTIG[ctg]);
+	}
+	this->areas.merge(other.areas);
+}
+
+
+void FRC::mergeAreas(const SuspiciousAreas &areas) {
+	this->areas.merge(areas);
+}
+
+const SuspiciousAreas &FRC::getAreas() const {
+	return this->areas;
 }
 
 
@@ -58,80 +72,20 @@ float FRC::obtainCoverage(unsigned int ctg, Contig *contig) {
 void FRC::computeCEstats(Contig *contig, unsigned int windowSize, unsigned int windowStep, float insertionMean, float insertionStd ) {
 
 	unsigned int contigLength = contig->getContigLength();
-	unsigned long int spanningCoverage = 0; // total insert length
-	unsigned int inserts = 0; // number of inserts
-	float localMean;
-	float Z_stats = 0;
-
-	unsigned int minInsertNum = 5;
+	WindowSums<InsertTrack> insertSums(contig->getInserts(), contigLength, windowResolution(windowSize, windowStep));
 	if(contigLength < windowSize) { // if contig less than window size, only one window
-		for(unsigned int i=0; i < contigLength ; i++ ) {
-			if(contig->CONTIG[i].StratingInserts > 0) {
-				inserts += contig->CONTIG[i].StratingInserts;
-				spanningCoverage += contig->CONTIG[i].insertsLength;
-			}
-			//spanningCoverage += contig->CONTIG[i].InsertCoverage;
-		}
-		if(inserts > minInsertNum) {
-			localMean = spanningCoverage/(float)inserts;
-			Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-			Z_stats = floorf(Z_stats * 10) / 10;
-			if(this->CEstatistics.count(Z_stats) == 1) {
-				this->CEstatistics[Z_stats]++;
-			} else {
-				this->CEstatistics[Z_stats] = 1;
-			}
-			//cout << Z_stats << "\n";
-
-		}
+		updateCEstats(insertSums, 0, contigLength, insertionMean, insertionStd);
 	} else { //otherwise compute features on sliding window
 		unsigned int startWindow = 0;
 		unsigned int endWindow   = windowSize;
-		for(unsigned int i=startWindow; i < endWindow; i++ ) {
-			if(contig->CONTIG[i].StratingInserts > 0) {
-				inserts += contig->CONTIG[i].StratingInserts;
-				spanningCoverage += contig->CONTIG[i].insertsLength;
-			}
-			//spanningCoverage += contig->CONTIG[i].InsertCoverage;
-		}
-		if(inserts > minInsertNum) {
-			localMean = spanningCoverage/(float)inserts;
-			Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-			Z_stats = floorf(Z_stats * 10) / 10;
-			if(this->CEstatistics.count(Z_stats) == 1) {
-				this->CEstatistics[Z_stats]++;
-			} else {
-				this->CEstatistics[Z_stats] = 1;
-			}
-			//cout << Z_stats << "\n";
-
-		}
+		updateCEstats(insertSums, startWindow, endWindow, insertionMean, insertionStd);
 		startWindow += windowStep;
 		endWindow += windowStep;
 		if(endWindow > contigLength) {
 			endWindow = contigLength;
 		}
 		while(endWindow < contigLength) {
-			inserts = 0; //reset window coverage
-			spanningCoverage = 0;
-			for(unsigned int i=startWindow; i < endWindow; i++ ) {
-				if(contig->CONTIG[i].StratingInserts > 0) {
-					inserts += contig->CONTIG[i].StratingInserts;
-					spanningCoverage += contig->CONTIG[i].insertsLength;
-				}
-				//spanningCoverage += contig->CONTIG[i].InsertCoverage;
-			}
-			if(inserts > minInsertNum) {
-				localMean = spanningCoverage/(float)inserts;
-				Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
-				Z_stats = floorf(Z_stats * 10) / 10;
-				if(this->CEstatistics.count(Z_stats) == 1) {
-					this->CEstatistics[Z_stats]++;
-				} else {
-					this->CEstatistics[Z_stats] = 1;
-				}
-				//cout << Z_stats << "\n";
-			}
+			updateCEstats(insertSums, startWindow, endWindow, insertionMean, insertionStd);
 			startWindow += windowStep;
 			endWindow += windowStep;
 			if(endWindow > contigLength) {
@@ -142,165 +96,178 @@ void FRC::computeCEstats(Contig *contig, unsigned int windowSize, unsigned int w
 }
 
 
-
-void FRC::computeLowCoverageArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getLowCoverageAreas(C_A,windowSize, windowStep);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateLOW_COVERAGE_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateLOW_COVERAGE_AREA(feat);
-	}
-	for(unsigned int i=0; i< contig->lowCoverageAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "LOW_COV_"+type;
-		tmp.start = contig->lowCoverageAreas.at(i).first;
-		tmp.end = contig->lowCoverageAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
+void FRC::updateCEstats(const WindowSums<InsertTrack> &insertSums, unsigned int startWindow, unsigned int endWindow, float insertionMean, float insertionStd) {
+	unsigned int minInsertNum = 5;
+	insertStatistics window = insertSums.sum(startWindow, endWindow);
+	unsigned int inserts = window.inserts; // number of inserts
+	unsigned long int spanningCoverage = window.insertsLength; // total insert length
+	if(inserts > minInsertNum) {
+		float localMean = spanningCoverage/(float)inserts;
+		float Z_stats   = (localMean - insertionMean)/(float)(insertionStd/sqrt(inserts)); // CE statistics
+		addCEstats(Z_stats);
 	}
-
 }
 
-void FRC::computeHighCoverageArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getHighCoverageAreas(this->C_A, windowSize, windowStep);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateHIGH_COVERAGE_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateHIGH_COVERAGE_AREA(feat);
-	}
 
-	for(unsigned int i=0; i< contig->highCoverageAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "HIGH_COV_"+type;
-		tmp.start = contig->highCoverageAreas.at(i).first;
-		tmp.end = contig->highCoverageAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
-		//cout << "\t" << tmp.feature << " " << tmp.start << " " << tmp.end << "\n";
+void FRC::addCEstats(float Z_stats) {
+	this->CEstatistics.add(Z_stats);
+}
+
+
+
+// records the features found on a contig and appends their areas to the suspicious ones
+void FRC::addAreas(bool is_mp, unsigned int ctg, Feature feature, unsigned int feat, const vector<pair<unsigned int, unsigned int> > &found, SuspiciousAreas &areas) {
+	Features &features = is_mp ? this->CONTIG[ctg].MP : this->CONTIG[ctg].PE;
+	FeatureTypes type;
+	switch (feature) { // coverage areas are PE features only
+	case LOW_COVERAGE_AREA:
+		features.updateLOW_COVERAGE_AREA(feat);
+		type = LOW_COV_PE;
+		break;
+	case HIGH_COVERAGE_AREA:
+		features.updateHIGH_COVERAGE_AREA(feat);
+		type = HIGH_COV_PE;
+		break;
+	case LOW_NORMAL_AREA:
+		features.updateLOW_NORMAL_AREA(feat);
+		type = LOW_NORM_COV_PE;
+		break;
+	case HIGH_NORMAL_AREA:
+		features.updateHIGH_NORMAL_AREA(feat);
+		type = HIGH_NORM_COV_PE;
+		break;
+	case HIGH_SINGLE_AREA:
+		features.updateHIGH_SINGLE_AREA(feat);
+		type = is_mp ? HIGH_SINGLE_MP : HIGH_SINGLE_PE;
+		break;
+	case HIGH_SPANNING_AREA:
+		features.updateHIGH_SPANNING_AREA(feat);
+		type = is_mp ? HIGH_SPAN_MP : HIGH_SPAN_PE;
+		break;
+	case HIGH_OUTIE_AREA:
+		features.updateHIGH_OUTIE_AREA(feat);
+		type = is_mp ? HIGH_OUTIE_MP : HIGH_OUTIE_PE;
+		break;
+	case COMPRESSION_AREA:
+		features.updateCOMPRESSION_AREA(feat);
+		type = is_mp ? COMPR_MP : COMPR_PE;
+		break;
+	case STRECH_AREA:
+		features.updateSTRECH_AREA(feat);
+		type = is_mp ? STRECH_MP : STRECH_PE;
+		break;
+	default:
+		cout << "THis whould never happen\n";
+		return;
 	}
-}
 
-void FRC::computeLowNormalArea(string type,unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getLowNormalAreas(this->C_M, windowSize, windowStep);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateLOW_NORMAL_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateLOW_NORMAL_AREA(feat);
-	}
-	for(unsigned int i=0; i < contig->lowNormalAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "LOW_NORM_COV_"+type;
-		tmp.start = contig->lowNormalAreas.at(i).first;
-		tmp.end = contig->lowNormalAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
+	suspiciousArea area;
+	area.feature = type;
+	area.library = this->library;
+	for(unsigned int i=0; i < found.size(); i++) {
+		area.start = found[i].first;
+		area.end   = found[i].second;
+		areas.add(ctg, area);
 	}
 }
 
-void FRC::computeHighNormalArea(string type,unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getHighNormalAreas(this->C_M, windowSize, windowStep);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateHIGH_NORMAL_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateHIGH_NORMAL_AREA(feat);
-	}
 
-	for(unsigned int i=0; i< contig->highNormalAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "HIGH_NORM_COV_"+type;
-		tmp.start = contig->highNormalAreas.at(i).first;
-		tmp.end = contig->highNormalAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
-	}
+void FRC::computeFeatures(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep,
+		float CE_min, float CE_max, unsigned int CEwindowSize, unsigned int CEwindowStep) {
+	unsigned int features[TOTAL];
+	vector<float> CEvalues;
+	detectFeatures(type, contig, windowSize, windowStep, CE_min, CE_max, CEwindowSize, CEwindowStep, features, CEvalues);
+	addFeatures(type, ctg, contig, features, CEvalues);
 }
 
-void FRC::computeHighSingleArea(string type,unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getHighSingleAreas( windowSize, windowStep, this->C_A);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateHIGH_SINGLE_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateHIGH_SINGLE_AREA(feat);
-	}
 
-	for(unsigned int i=0; i< contig->highSingleAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "HIGH_SINGLE_"+type;
-		tmp.start = contig->highSingleAreas.at(i).first;
-		tmp.end = contig->highSingleAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
+void FRC::detectFeatures(string type, Contig *contig, unsigned int windowSize, unsigned int windowStep,
+		float CE_min, float CE_max, unsigned int CEwindowSize, unsigned int CEwindowStep, unsigned int features[TOTAL], vector<float> &CEvalues) const {
+	bool is_mp = type.compare("PE") != 0;
+	contig->computeAreas(is_mp, this->C_A, this->C_M, this->insertMean, this->insertStd, CE_min, CE_max,
+			windowSize, windowStep, CEwindowSize, CEwindowStep, features, CEvalues);
+}
 
-	}
 
+void FRC::addFeatures(string type, unsigned int ctg, Contig *contig, unsigned int features[TOTAL], const vector<float> &CEvalues) {
+	addCEvalues(CEvalues);
+	addContigFeatures(type, ctg, contig, features);
 }
 
-void FRC::computeHighSpanningArea(string type,unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getHighSpanningAreas( windowSize, windowStep, this->C_A);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateHIGH_SPANNING_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateHIGH_SPANNING_AREA(feat);
+
+void FRC::addCEvalues(const vector<float> &CEvalues) {
+	for(unsigned int i=0; i < CEvalues.size(); i++) {
+		addCEstats(CEvalues[i]);
 	}
+}
 
-	for(unsigned int i=0; i< contig->highSpanningAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "HIGH_SPAN_"+type;
-		tmp.start = contig->highSpanningAreas.at(i).first;
-		tmp.end = contig->highSpanningAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
 
-	}
+void FRC::addContigFeatures(string type, unsigned int ctg, Contig *contig, unsigned int features[TOTAL]) {
+	addContigFeatures(type, ctg, contig, features, this->areas);
 }
 
-void FRC::computeHighOutieArea(string type,unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getHighOutieAreas( windowSize, windowStep, this->C_A);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateHIGH_OUTIE_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateHIGH_OUTIE_AREA(feat);
-	}
 
-	for(unsigned int i=0; i < contig->highOutieAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "HIGH_OUTIE_"+type;
-		tmp.start = contig->highOutieAreas.at(i).first;
-		tmp.end = contig->highOutieAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
+void FRC::addContigFeatures(string type, unsigned int ctg, Contig *contig, unsigned int features[TOTAL], SuspiciousAreas &areas) {
+	bool is_mp = type.compare("PE") != 0;
+	// same order as the single compute*Area calls: the suspicious areas are sorted with an unstable sort
+	if(!is_mp) {
+		addAreas(is_mp, ctg, LOW_COVERAGE_AREA, features[LOW_COVERAGE_AREA], contig->lowCoverageAreas, areas);
+		addAreas(is_mp, ctg, HIGH_COVERAGE_AREA, features[HIGH_COVERAGE_AREA], contig->highCoverageAreas, areas);
+		addAreas(is_mp, ctg, LOW_NORMAL_AREA, features[LOW_NORMAL_AREA], contig->lowNormalAreas, areas);
+		addAreas(is_mp, ctg, HIGH_NORMAL_AREA, features[HIGH_NORMAL_AREA], contig->highNormalAreas, areas);
 	}
+	addAreas(is_mp, ctg, HIGH_SINGLE_AREA, features[HIGH_SINGLE_AREA], contig->highSingleAreas, areas);
+	addAreas(is_mp, ctg, HIGH_OUTIE_AREA, features[HIGH_OUTIE_AREA], contig->highOutieAreas, areas);
+	addAreas(is_mp, ctg, HIGH_SPANNING_AREA, features[HIGH_SPANNING_AREA], contig->highSpanningAreas, areas);
+	addAreas(is_mp, ctg, COMPRESSION_AREA, features[COMPRESSION_AREA], contig->compressionAreas, areas);
+	addAreas(is_mp, ctg, STRECH_AREA, features[STRECH_AREA], contig->expansionAreas, areas);
+}
+
 
+void FRC::computeLowCoverageArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getLowCoverageAreas(this->C_A, windowSize, windowStep);
+	addAreas(type.compare("PE") != 0, ctg, LOW_COVERAGE_AREA, feat, contig->lowCoverageAreas, this->areas);
 }
 
-void FRC::computeCompressionArea(string type,unsigned int ctg, Contig *contig, float Zscore , unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getCompressionAreas(this->insertMean, this->insertStd, Zscore, windowSize, windowStep);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateCOMPRESSION_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateCOMPRESSION_AREA(feat);
-	}
+void FRC::computeHighCoverageArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getHighCoverageAreas(this->C_A, windowSize, windowStep);
+	addAreas(type.compare("PE") != 0, ctg, HIGH_COVERAGE_AREA, feat, contig->highCoverageAreas, this->areas);
+}
 
-	for(unsigned int i=0; i< contig->compressionAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "COMPR_"+type;
-		tmp.start = contig->compressionAreas.at(i).first;
-		tmp.end = contig->compressionAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
-	}
+void FRC::computeLowNormalArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getLowNormalAreas(this->C_M, windowSize, windowStep);
+	addAreas(type.compare("PE") != 0, ctg, LOW_NORMAL_AREA, feat, contig->lowNormalAreas, this->areas);
+}
 
+void FRC::computeHighNormalArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getHighNormalAreas(this->C_M, windowSize, windowStep);
+	addAreas(type.compare("PE") != 0, ctg, HIGH_NORMAL_AREA, feat, contig->highNormalAreas, this->areas);
 }
 
-void FRC::computeStrechArea(string type,unsigned int ctg, Contig *contig, float Zscore, unsigned int windowSize, unsigned int windowStep) {
-	unsigned int feat = contig->getExpansionAreas(this->insertMean, this->insertStd, Zscore, windowSize, windowStep);
-	if(type.compare("PE") == 0) {
-		this->CONTIG[ctg].PE.updateSTRECH_AREA(feat);
-	} else {
-		this->CONTIG[ctg].MP.updateSTRECH_AREA(feat);
-	}
+void FRC::computeHighSingleArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getHighSingleAreas(windowSize, windowStep, this->C_A);
+	addAreas(type.compare("PE") != 0, ctg, HIGH_SINGLE_AREA, feat, contig->highSingleAreas, this->areas);
+}
 
-	for(unsigned int i=0; i < contig->expansionAreas.size(); i++) {
-		ternary tmp;
-		tmp.feature = "STRECH_"+type;
-		tmp.start = contig->expansionAreas.at(i).first;
-		tmp.end = contig->expansionAreas.at(i).second;
-		this->CONTIG[ctg].SUSPICIOUS_AREAS.push_back(tmp);
-	}
+void FRC::computeHighSpanningArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getHighSpanningAreas(windowSize, windowStep, this->C_A);
+	addAreas(type.compare("PE") != 0, ctg, HIGH_SPANNING_AREA, feat, contig->highSpanningAreas, this->areas);
+}
+
+void FRC::computeHighOutieArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getHighOutieAreas(windowSize, windowStep, this->C_A);
+	addAreas(type.compare("PE") != 0, ctg, HIGH_OUTIE_AREA, feat, contig->highOutieAreas, this->areas);
+}
+
+void FRC::computeCompressionArea(string type, unsigned int ctg, Contig *contig, float Zscore, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getCompressionAreas(this->insertMean, this->insertStd, Zscore, windowSize, windowStep);
+	addAreas(type.compare("PE") != 0, ctg, COMPRESSION_AREA, feat, contig->compressionAreas, this->areas);
 }
 
+void FRC::computeStrechArea(string type, unsigned int ctg, Contig *contig, float Zscore, unsigned int windowSize, unsigned int windowStep) {
+	unsigned int feat = contig->getExpansionAreas(this->insertMean, this->insertStd, Zscore, windowSize, windowStep);
+	addAreas(type.compare("PE") != 0, ctg, STRECH_AREA, feat, contig->expansionAreas, this->areas);
+}
 
 
 void FRC::setC_A(float C_A) {
@@ -337,15 +304,28 @@ string  FRC::getID(unsigned int i) {
 }
 
 
-void FRC::printFeaturesGFF3(unsigned int ctg, ofstream &file) {
-	this->CONTIG[ctg].printFeaturesGFF3(file);
+bool startsBefore(const suspiciousArea &a1, const suspiciousArea &a2) {return (a1.start < a2.start);}
 
-}
+void FRC::printFeaturesGFF3(unsigned int ctg, TextWriter &file) {
+	string contigID = this->CONTIG[ctg].getID();
+	file << "##sequence-region\t" << contigID <<  "\t" << 1 << "\t" << this->CONTIG[ctg].getContigLength() << "\n";
 
+	sort(areas.begin(ctg), areas.end(ctg), startsBefore);
+	for(vector<suspiciousArea>::iterator area = areas.begin(ctg); area != areas.end(ctg); ++area) {
+		string feature = returnFeatureName((FeatureTypes)area->feature);
+		file << contigID << "\t" << "." << "\t" << feature << "\t";
+		file << area->start + 1 << "\t" <<  area->end -1 << "\t";
+		file << "." << "\t" << "+" << "\t" << "." << "\t" << "Name=" << feature << "\n";
+	}
+}
 
-void FRC::printFeatures(unsigned int ctg, ofstream &file) {
-	this->CONTIG[ctg].printFeatures(file);
 
+void FRC::printFeatures(unsigned int ctg, TextWriter &file) {
+	string contigID = this->CONTIG[ctg].getID();
+	sort(areas.begin(ctg), areas.end(ctg), startsBefore);
+	for(vector<suspiciousArea>::iterator area = areas.begin(ctg); area != areas.end(ctg); ++area) {
+		file << contigID << " " << returnFeatureName((FeatureTypes)area->feature) << " " << area->start << " " << area->end << "\n";
+	}
 }
 
 
@@ -461,7 +441,6 @@ unsigned int FRC::getSTRECH_MP(unsigned int ctg) {
 contigFeatures::contigFeatures() {
 	contigLength = 0;
 	TOTAL = 0;
-	SUSPICIOUS_AREAS.clear();
 }
 
 contigFeatures::~contigFeatures() {
@@ -472,7 +451,7 @@ void contigFeatures::setContigLength(unsigned int contigLength) {
 	this->contigLength = contigLength;
 }
 
-unsigned long int contigFeatures::getContigLength() {
+unsigned long int contigFeatures::getContigLength() const {
 	return this->contigLength;
 }
 
@@ -553,34 +532,8 @@ unsigned int contigFeatures::getSTRECH_MP() {
 
 
 
-bool sortTernary(ternary t1, ternary t2) {return (t1.start < t2.start);}
-
-void contigFeatures::printFeatures(ofstream &file) {
-	unsigned int total = 0;
-	sort(SUSPICIOUS_AREAS.begin(), SUSPICIOUS_AREAS.end(), sortTernary);
-	for(unsigned int i=0; i < SUSPICIOUS_AREAS.size(); i++) {
-		file << this->contigID << " " << SUSPICIOUS_AREAS[i].feature << " " << SUSPICIOUS_AREAS[i].start << " " << SUSPICIOUS_AREAS[i].end << "\n";
-		total += floor((SUSPICIOUS_AREAS[i].end - SUSPICIOUS_AREAS[i].start + 1)/(float)1000 + 0.5);
-		//total++;
-	}
-	this->TOTAL = total;
-
-
-}
-
-void contigFeatures::printFeaturesGFF3(ofstream &file) {
-
-	file << "##sequence-region\t" << this->contigID <<  "\t" << 1 << "\t" << this->contigLength << "\n";
-
-	sort(SUSPICIOUS_AREAS.begin(), SUSPICIOUS_AREAS.end(), sortTernary);
-	for(unsigned int i=0; i < SUSPICIOUS_AREAS.size(); i++) {
-		file << this->contigID << "\t" << "." << "\t" << SUSPICIOUS_AREAS[i].feature << "\t";
-		file << SUSPICIOUS_AREAS[i].start + 1 << "\t" <<  SUSPICIOUS_AREAS[i].end -1 << "\t";
-		file << "." << "\t" << "+" << "\t" << "." << "\t" << "Name=" << SUSPICIOUS_AREAS[i].feature << "\n";
-	}
-
-
+// as if the other library had been evaluated on this object
+void contigFeatures::mergeFeatures(const contigFeatures &other) {
+	PE.merge(other.PE);
+	MP.merge(other.MP);
 }
-
-
-
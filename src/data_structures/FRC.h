@@ -18,6 +18,7 @@
 //#include "common.h"
 //#include "Features.h"
 #include "Contig.h"
+#include "CEHistogram.h"
 
 
 class contigFeatures {
@@ -39,7 +40,7 @@ public:
 	string getID();
 
 	void setContigLength(unsigned int contigLength);
-	unsigned long int getContigLength();
+	unsigned long int getContigLength() const;
 
 
 	unsigned int getTotal();
@@ -61,10 +62,7 @@ public:
 	unsigned int getCOMPR_MP();
 	unsigned int getSTRECH_MP();
 
-	vector<ternary> SUSPICIOUS_AREAS;
-
-	void printFeatures(ofstream &file);
-	void printFeaturesGFF3(ofstream &file);
+	void mergeFeatures(const contigFeatures &other);
 
 };
 
@@ -88,13 +86,20 @@ class FRC {
     float insertMean;
     float insertStd;
 
+    void updateCEstats(const WindowSums<InsertTrack> &insertSums, unsigned int startWindow, unsigned int endWindow, float insertionMean, float insertionStd);
+    void addCEstats(float Z_stats);
+    SuspiciousAreas areas; // of all the contigs
+    unsigned int library;  // id of the library the areas are found with
+
+    void addAreas(bool is_mp, unsigned int ctg, Feature feature, unsigned int feat, const vector<pair<unsigned int, unsigned int> > &found, SuspiciousAreas &areas);
+
 public:
 
 	FRC();
 	FRC(unsigned int contigs);
 	~FRC();
 
-	map<float, unsigned int> CEstatistics;
+	CEHistogram CEstatistics;
 
 	unsigned int returnContigs();
 	void setContigLength(unsigned int ctg, unsigned int contigLength);
@@ -111,11 +116,32 @@ public:
 	void setID(unsigned int i, string ID);
 	string  getID(unsigned int i);
 
-	void sortFRC();
+	void setLibrary(unsigned int library);
+
+	// adds the features and suspicious areas of other, a FRC object over the same contigs evaluated on another library
+	// (CE statistics are not merged)
+	void mergeFeatures(const FRC &other);
 	float obtainCoverage(unsigned int ctg, Contig *contig);
 
 	void computeCEstats(Contig *contig, unsigned int WindowSize, unsigned int WindowStep, float mean, float std);
 
+	// every feature of the library (type PE or MP) and the CE statistics in a single sweep over the contig
+	void computeFeatures(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep,
+			float CE_min, float CE_max, unsigned int CEwindowSize, unsigned int CEwindowStep);
+	// the same in two steps: detectFeatures only reads the FRC (several contigs can be processed at the same time),
+	// addFeatures stores the results of a contig
+	void detectFeatures(string type, Contig *contig, unsigned int windowSize, unsigned int windowStep,
+			float CE_min, float CE_max, unsigned int CEwindowSize, unsigned int CEwindowStep, unsigned int features[TOTAL], vector<float> &CEvalues) const;
+	void addFeatures(string type, unsigned int ctg, Contig *contig, unsigned int features[TOTAL], const vector<float> &CEvalues);
+	// addFeatures split again: addContigFeatures only touches the features of contig ctg (contigs can be stored at the same time),
+	// addCEvalues updates the CE statistics shared by all the contigs
+	void addContigFeatures(string type, unsigned int ctg, Contig *contig, unsigned int features[TOTAL]);
+	// the same, with the areas added to a table of the caller (e.g. of a thread) and merged later with mergeAreas
+	void addContigFeatures(string type, unsigned int ctg, Contig *contig, unsigned int features[TOTAL], SuspiciousAreas &areas);
+	void mergeAreas(const SuspiciousAreas &areas);
+	const SuspiciousAreas &getAreas() const;
+	void addCEvalues(const vector<float> &CEvalues);
+
 	void computeLowCoverageArea(string type, unsigned int ctg, Contig *contig, unsigned int WindowSize, unsigned int WindowStep);
 	void computeHighCoverageArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep);
 	void computeLowNormalArea(string type, unsigned int ctg, Contig *contig, unsigned int windowSize, unsigned int windowStep);
@@ -148,9 +174,9 @@ public:
 
 
 
-	void printFeatures(unsigned int ctg, ofstream &f);
+	void printFeatures(unsigned int ctg, TextWriter &f);
 
-	void printFeaturesGFF3(unsigned int ctg, ofstream &f);
+	void printFeaturesGFF3(unsigned int ctg, TextWriter &f);
 
 
 };
@@ -0,0 +1,164 @@
+#include "FRCurve.h"
+
+
+#define FRCURVES_MAGIC   0x43435246 // "FRCC"
+#define FRCURVES_VERSION 1
+
+
+FRCurve::FRCurve() {
+	this->type       = FRC_TOTAL;
+	this->genomeSize = 0;
+}
+
+FRCurve::FRCurve(FeatureTypes type, uint64_t genomeSize, const vector<uint32_t> &prefixFeatures, const vector<uint64_t> &prefixLengths) {
+	this->type       = type;
+	this->genomeSize = genomeSize;
+	// a breakpoint for every number of features: the longest prefix with that many features
+	for(unsigned int i = 0; i < prefixFeatures.size(); i++) {
+		if(i + 1 == prefixFeatures.size() or prefixFeatures[i + 1] != prefixFeatures[i]) {
+			features.push_back(prefixFeatures[i]);
+			lengths.push_back(prefixLengths[i]);
+		}
+	}
+}
+
+
+FeatureTypes FRCurve::getType() const {
+	return type;
+}
+
+uint32_t FRCurve::totalFeatures() const {
+	return features.empty() ? 0 : features.back();
+}
+
+
+float FRCurve::coverageAt(float features) const {
+	vector<uint32_t>::const_iterator above = upper_bound(this->features.begin(), this->features.end(), features);
+	if(above == this->features.begin() or genomeSize == 0) {
+		return 0;
+	}
+	return 100*(lengths[above - this->features.begin() - 1]/(double)genomeSize);
+}
+
+
+int64_t FRCurve::featuresAt(float coverage) const {
+	double target = coverage/100.0 * genomeSize;
+	vector<uint64_t>::const_iterator covered = lower_bound(lengths.begin(), lengths.end(), (uint64_t)ceil(target));
+	if(covered == lengths.end()) {
+		return -1;
+	}
+	return features[covered - lengths.begin()];
+}
+
+
+double FRCurve::area(float maxFeatures) const {
+	if(maxFeatures <= 0 or features.empty() or genomeSize == 0) {
+		return coverageAt(0);
+	}
+	double area = 0;
+	for(unsigned int j = 0; j < features.size() and features[j] < maxFeatures; j++) {
+		double next = j + 1 < features.size() ? min((double)features[j + 1], (double)maxFeatures) : maxFeatures;
+		area += lengths[j] * (next - features[j]);
+	}
+	return 100*(area/maxFeatures/genomeSize);
+}
+
+
+bool FRCurve::write(FILE *file) const {
+	uint32_t type   = this->type;
+	uint32_t points = features.size();
+	fwrite(&type, sizeof(type), 1, file);
+	fwrite(&genomeSize, sizeof(genomeSize), 1, file);
+	fwrite(&points, sizeof(points), 1, file);
+	if(points > 0) {
+		fwrite(&features[0], sizeof(uint32_t), points, file);
+		fwrite(&lengths[0], sizeof(uint64_t), points, file);
+	}
+	return !ferror(file);
+}
+
+bool FRCurve::read(FILE *file, long fileSize) {
+	uint32_t type;
+	uint32_t points;
+	if(fread(&type, sizeof(type), 1, file) != 1 or fread(&genomeSize, sizeof(genomeSize), 1, file) != 1 or
+			fread(&points, sizeof(points), 1, file) != 1 or type >= FEATURE_TYPES) {
+		return false;
+	}
+	long position = ftell(file); // the points must be in the file before they are allocated
+	if(position < 0 or (uint64_t)points > (uint64_t)(fileSize - position) / (sizeof(uint32_t) + sizeof(uint64_t))) {
+		return false;
+	}
+	this->type = (FeatureTypes)type;
+	features.resize(points);
+	lengths.resize(points);
+	if(points > 0 and (fread(&features[0], sizeof(uint32_t), points, file) != points or fread(&lengths[0], sizeof(uint64_t), points, file) != points)) {
+		return false;
+	}
+	return true;
+}
+
+
+
+bool writeFRCurves(string fileName, const vector<FRCurve> &curves) {
+	FILE *file = fopen(fileName.c_str(), "wb");
+	if(file == NULL) {
+		return false;
+	}
+	uint32_t header[3] = {FRCURVES_MAGIC, FRCURVES_VERSION, (uint32_t)curves.size()};
+	bool ok = fwrite(header, sizeof(header), 1, file) == 1;
+	for(unsigned int i = 0; ok and i < curves.size(); i++) {
+		ok = curves[i].write(file);
+	}
+	return fclose(file) == 0 and ok;
+}
+
+bool readFRCurves(string fileName, vector<FRCurve> &curves) {
+	FILE *file = fopen(fileName.c_str(), "rb");
+	if(file == NULL) {
+		return false;
+	}
+	long fileSize = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+	rewind(file);
+	uint32_t header[3];
+	bool ok = fileSize >= 0 and fread(header, sizeof(header), 1, file) == 1 and header[0] == FRCURVES_MAGIC and header[1] == FRCURVES_VERSION and
+			header[2] <= FEATURE_TYPES;
+	if(ok) {
+		curves.resize(header[2]);
+	}
+	for(unsigned int i = 0; ok and i < curves.size(); i++) {
+		ok = curves[i].read(file, fileSize);
+	}
+	fclose(file);
+	return ok and !curves.empty() and curves[0].getType() == FRC_TOTAL;
+}
+
+
+
+struct betterArea {
+	const vector<double> &areas;
+	betterArea(const vector<double> &areas) : areas(areas) {}
+	bool operator()(unsigned int i, unsigned int j) const {
+		return areas[i] > areas[j];
+	}
+};
+
+void printRanking(ostream &file, const vector<string> &assemblies, const vector<vector<FRCurve> > &curves) {
+	uint32_t maxFeatures = 0;
+	for(unsigned int i = 0; i < curves.size(); i++) {
+		maxFeatures = max(maxFeatures, curves[i][FRC_TOTAL].totalFeatures());
+	}
+	vector<double> areas;
+	vector<unsigned int> rank;
+	for(unsigned int i = 0; i < curves.size(); i++) {
+		areas.push_back(curves[i][FRC_TOTAL].area(maxFeatures));
+		rank.push_back(i);
+	}
+	stable_sort(rank.begin(), rank.end(), betterArea(areas));
+
+	file << "rank assembly features AUC COVERAGE_AT_" << maxFeatures << " FEATURES_AT_50\n";
+	for(unsigned int r = 0; r < rank.size(); r++) {
+		const FRCurve &curve = curves[rank[r]][FRC_TOTAL];
+		file << r + 1 << " " << assemblies[rank[r]] << " " << curve.totalFeatures() << " " << areas[rank[r]] << " ";
+		file << curve.coverageAt(maxFeatures) << " " << curve.featuresAt(50) << "\n";
+	}
+}
@@ -0,0 +1,62 @@
+#ifndef FRCURVE_H_
+#define FRCURVE_H_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <ostream>
+
+#include "common.h"
+
+using namespace std;
+
+
+#define FEATURE_TYPES (STRECH_MP + 1) // FRC_TOTAL and every feature type
+
+
+/*
+ * A FRCurve as a step function: features[j] features allow to cover (with the longest contigs first) lengths[j] bases,
+ * and lengths[j] is the most that can be covered before the next contig with features. Only the contigs with features
+ * of the type are breakpoints, so the curve is much smaller than the assembly. Queries are binary searches.
+ */
+class FRCurve {
+	FeatureTypes type;
+	uint64_t genomeSize; // estimated genome size the coverage is computed on
+	vector<uint32_t> features;
+	vector<uint64_t> lengths;
+
+public:
+	FRCurve();
+	// from the prefix sums of features and contig lengths over the contigs sorted by decreasing length (see FRCurveBuilder)
+	FRCurve(FeatureTypes type, uint64_t genomeSize, const vector<uint32_t> &prefixFeatures, const vector<uint64_t> &prefixLengths);
+
+	FeatureTypes getType() const;
+	uint32_t totalFeatures() const;
+
+	// % of the genome covered allowing at most this many features
+	float coverageAt(float features) const;
+	// fewest features needed to cover this % of the genome, -1 if it is never covered
+	int64_t featuresAt(float coverage) const;
+	// mean coverage (%) of the curve for 0 to maxFeatures features: the area under the curve over maxFeatures
+	double area(float maxFeatures) const;
+
+	bool write(FILE *file) const;
+	bool read(FILE *file, long fileSize); // false on a truncated or corrupt curve
+};
+
+
+// all the curves of a run, FRC_TOTAL first, in a compact binary file (OUTPUT + FRCURVES_SUFFIX)
+#define FRCURVES_SUFFIX "_FRCurves.bin"
+
+bool writeFRCurves(string fileName, const vector<FRCurve> &curves);
+bool readFRCurves(string fileName, vector<FRCurve> &curves);
+
+/*
+ * Ranks the assemblies by the area under their FRC_TOTAL curves, all integrated up to the largest number of features
+ * of any assembly (a curve that ends earlier keeps its final coverage). One line per assembly, best first: rank, name,
+ * features, area, coverage at that number of features and features needed to cover 50% of the genome.
+ */
+void printRanking(ostream &file, const vector<string> &assemblies, const vector<vector<FRCurve> > &curves);
+
+
+#endif /* FRCURVE_H_ */
@@ -0,0 +1,127 @@
+#include "FRCurveBuilder.h"
+#include <fstream>
+
+
+struct longerContig {
+	const vector<unsigned int> &length;
+	longerContig(const vector<unsigned int> &length) : length(length) {}
+	bool operator()(unsigned int i, unsigned int j) const {
+		return length[i] > length[j];
+	}
+};
+
+// compared as the uint32_t feature counter and the float step of the original curve loop
+struct featuresAbove {
+	bool operator()(float features, uint32_t prefix) const {
+		return features < prefix;
+	}
+};
+
+
+FRCurveBuilder::FRCurveBuilder(FRC &frc) {
+	unsigned int contigs = frc.returnContigs();
+	vector<unsigned int> length(contigs);
+	order.resize(contigs);
+	for(unsigned int i = 0; i < contigs; i++) {
+		length[i] = frc.getContigLength(i);
+		order[i]  = i;
+	}
+	stable_sort(order.begin(), order.end(), longerContig(length));
+
+	lengths.resize(contigs + 1);
+	IDs.resize(contigs);
+	for(unsigned int type = 0; type < FEATURE_TYPES; type++) {
+		features[type].resize(contigs + 1);
+		features[type][0] = 0;
+	}
+	lengths[0] = 0;
+	for(unsigned int i = 0; i < contigs; i++) {
+		unsigned int ctg = order[i];
+		lengths[i + 1] = lengths[i] + length[ctg];
+		IDs[i] = frc.getID(ctg);
+		for(unsigned int type = 0; type < FEATURE_TYPES; type++) {
+			features[type][i + 1] = features[type][i] + frc.getFeatures((FeatureTypes)type, ctg);
+		}
+	}
+}
+
+
+unsigned int FRCurveBuilder::contigs() const {
+	return order.size();
+}
+
+uint64_t FRCurveBuilder::totalFeatures(FeatureTypes type) const {
+	return features[type].back();
+}
+
+
+unsigned int FRCurveBuilder::contigsAbove(FeatureTypes type, float features) const {
+	const vector<uint32_t> &prefix = this->features[type];
+	// first prefix (of at least one contig) with more features
+	vector<uint32_t>::const_iterator above = upper_bound(prefix.begin() + 1, prefix.end(), features, featuresAbove());
+	if(above == prefix.end()) {
+		return contigs();
+	}
+	return above - prefix.begin() - 1;
+}
+
+uint64_t FRCurveBuilder::lengthOf(unsigned int contigs) const {
+	return lengths[contigs];
+}
+
+
+FRCurve FRCurveBuilder::curve(FeatureTypes type, uint64_t estimatedGenomeSize) const {
+	return FRCurve(type, estimatedGenomeSize, features[type], lengths);
+}
+
+
+void FRCurveBuilder::printFRCurve(string outputFile, int totalFeatNum, FeatureTypes type, uint64_t estimatedGenomeSize) const {
+	TextWriter myfile;
+	myfile.open(outputFile);
+
+	cout << "now computing " << returnFeatureName(type) << "\t";
+	if (totalFeatNum == 0 or contigs() == 0) {
+		myfile << "0 100\n";
+		cout << "No features of this kind: DONE\n";
+		return;
+	}
+	float step = totalFeatNum/(float)100;
+	float partial=0;
+
+	while(partial <= totalFeatNum) {
+		unsigned int contigStep = contigsAbove(type, partial);
+		uint64_t edgeCoverage   = lengthOf(contigStep);
+		float coveragePartial =  100*(edgeCoverage/(float)estimatedGenomeSize);
+		myfile << partial << " " << coveragePartial << "\n";
+		partial += step;
+
+		if(partial >= totalFeatNum) {
+			partial = totalFeatNum + 1;
+		}
+
+		if(contigStep >= contigs()) {
+			partial = totalFeatNum + 1;
+		}
+	}
+	cout << "\n";
+	myfile.close();
+}
+
+
+void FRCurveBuilder::printBreakpoints(string outputFile, uint64_t estimatedGenomeSize) const {
+	TextWriter file;
+	file.open(outputFile);
+	file << "contigID length coverage";
+	for(unsigned int type = 0; type < FEATURE_TYPES; type++) {
+		file << " " << returnFeatureName((FeatureTypes)type);
+	}
+	file << "\n";
+	for(unsigned int i = 0; i < contigs(); i++) {
+		file << IDs[i] << " " << lengths[i + 1] - lengths[i] << " " << 100*(lengths[i + 1]/(float)estimatedGenomeSize);
+		for(unsigned int type = 0; type < FEATURE_TYPES; type++) {
+			file << " " << features[type][i + 1];
+		}
+		file << "\n";
+	}
+	file.close();
+}
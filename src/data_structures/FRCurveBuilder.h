@@ -0,0 +1,44 @@
+#ifndef FRCURVEBUILDER_H_
+#define FRCURVEBUILDER_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "FRC.h"
+#include "FRCurve.h"
+
+using namespace std;
+
+
+/*
+ * The data every FRCurve is computed from: contigs ordered once by decreasing length (ties in header order), and
+ * prefix sums over that order of the contig lengths and of the features of each type.
+ * A curve point is then a binary search, all the curves are printed without touching (or copying) the FRC again.
+ */
+class FRCurveBuilder {
+	vector<unsigned int> order;     // contig indexes by decreasing length
+	vector<uint64_t> lengths;       // lengths[i]: length of the first i contigs of order
+	vector<uint32_t> features[FEATURE_TYPES]; // features[type][i]: features of this type on the first i contigs of order
+	vector<string> IDs;             // contig names, in order
+
+public:
+	FRCurveBuilder(FRC &frc);
+
+	unsigned int contigs() const;
+	uint64_t totalFeatures(FeatureTypes type) const;
+
+	// fewest contigs whose features of this type are more than features (all the contigs if there are not enough)
+	unsigned int contigsAbove(FeatureTypes type, float features) const;
+	uint64_t lengthOf(unsigned int contigs) const; // length of the first contigs
+
+	FRCurve curve(FeatureTypes type, uint64_t estimatedGenomeSize) const;
+
+	// FRCurve of a feature type in totalFeatNum/100 steps, as x y lines (features, % of estimatedGenomeSize covered)
+	void printFRCurve(string outputFile, int totalFeatNum, FeatureTypes type, uint64_t estimatedGenomeSize) const;
+	// exact curves: after every contig its name, length, % of estimatedGenomeSize covered and the features of every type so far
+	void printBreakpoints(string outputFile, uint64_t estimatedGenomeSize) const;
+};
+
+
+#endif /* FRCURVEBUILDER_H_ */
@@ -0,0 +1,189 @@
+#include "FeatureFile.h"
+#include <cstdio>
+#include "api/internal/io/BgzfStream_p.h"
+#include "api/internal/utils/BamException_p.h"
+
+using namespace BamTools::Internal;
+
+
+#define FEATURE_FILE_MAGIC    0x46435246 // "FRCF"
+#define FEATURE_INDEX_MAGIC   0x49435246 // "FRCI"
+#define FEATURE_FILE_VERSION  1
+
+
+static bool startsBefore(const suspiciousArea &a1, const suspiciousArea &a2) {
+	return a1.start < a2.start;
+}
+
+
+static void writeHeader(BgzfStream &file, FRC &frc) {
+	uint32_t header[3] = {FEATURE_FILE_MAGIC, FEATURE_FILE_VERSION, frc.returnContigs()};
+	file.Write((const char *)header, sizeof(header));
+	for(unsigned int ctg = 0; ctg < frc.returnContigs(); ctg++) {
+		string name = frc.getID(ctg);
+		uint32_t contig[2] = {(uint32_t)name.size(), frc.getContigLength(ctg)};
+		file.Write((const char *)contig, sizeof(contig));
+		file.Write(name.data(), name.size());
+	}
+}
+
+
+bool writeFeatureFile(string fileName, FRC &frc) {
+	const SuspiciousAreas &areas = frc.getAreas();
+	vector<vector<int64_t> > windows(frc.returnContigs());
+	BgzfStream file;
+	try {
+		file.Open(fileName, IBamIODevice::WriteOnly);
+		writeHeader(file, frc);
+		for(unsigned int ctg = 0; ctg < frc.returnContigs(); ctg++) {
+			vector<suspiciousArea> sorted(areas.begin(ctg), areas.end(ctg));
+			stable_sort(sorted.begin(), sorted.end(), startsBefore);
+			vector<int64_t> &window = windows[ctg];
+			window.assign((frc.getContigLength(ctg) >> FEATURE_INDEX_SHIFT) + 1, -1);
+			unsigned int indexed = 0; // windows up to here are already set (features are by start)
+			for(unsigned int i = 0; i < sorted.size(); i++) {
+				featureRecord record;
+				record.ctg     = ctg;
+				record.start   = sorted[i].start;
+				record.end     = sorted[i].end;
+				record.feature = sorted[i].feature;
+				record.library = sorted[i].library;
+				record.padding = 0;
+				int64_t offset = file.Tell();
+				unsigned int last = min((max(record.end, record.start + 1) - 1) >> FEATURE_INDEX_SHIFT, (uint32_t)window.size() - 1);
+				for(unsigned int w = max(record.start >> FEATURE_INDEX_SHIFT, indexed); w <= last; w++) {
+					window[w] = offset;
+				}
+				indexed = max(indexed, last + 1);
+				file.Write((const char *)&record, sizeof(record));
+			}
+			// windows without features start from the next feature
+			for(int w = (int)window.size() - 2; w >= 0; w--) {
+				if(window[w] == -1) {
+					window[w] = window[w + 1];
+				}
+			}
+		}
+		file.Close();
+	} catch(BamException &error) {
+		cerr << error.what() << "\n";
+		return false;
+	}
+
+	FILE *index = fopen((fileName + FEATURE_INDEX_SUFFIX).c_str(), "wb");
+	if(index == NULL) {
+		return false;
+	}
+	uint32_t header[3] = {FEATURE_INDEX_MAGIC, FEATURE_FILE_VERSION, (uint32_t)windows.size()};
+	fwrite(header, sizeof(header), 1, index);
+	for(unsigned int ctg = 0; ctg < windows.size(); ctg++) {
+		uint32_t size = windows[ctg].size();
+		fwrite(&size, sizeof(size), 1, index);
+		fwrite(&windows[ctg][0], sizeof(int64_t), size, index);
+	}
+	bool ok = !ferror(index);
+	return fclose(index) == 0 and ok;
+}
+
+
+
+bool FeatureFileReader::open(string fileName) {
+	this->fileName = fileName;
+	BgzfStream file;
+	try {
+		file.Open(fileName, IBamIODevice::ReadOnly);
+		uint32_t header[3];
+		if(file.Read((char *)header, sizeof(header)) != sizeof(header) or header[0] != FEATURE_FILE_MAGIC or header[1] != FEATURE_FILE_VERSION) {
+			return false;
+		}
+		names.resize(header[2]);
+		lengths.resize(header[2]);
+		for(unsigned int ctg = 0; ctg < names.size(); ctg++) {
+			uint32_t contig[2];
+			if(file.Read((char *)contig, sizeof(contig)) != sizeof(contig)) {
+				return false;
+			}
+			vector<char> name(contig[0]);
+			if(contig[0] > 0 and file.Read(&name[0], contig[0]) != contig[0]) {
+				return false;
+			}
+			names[ctg]   = string(name.begin(), name.end());
+			lengths[ctg] = contig[1];
+			ids[names[ctg]] = ctg;
+		}
+		file.Close();
+	} catch(BamException &error) {
+		cerr << error.what() << "\n";
+		return false;
+	}
+
+	FILE *index = fopen((fileName + FEATURE_INDEX_SUFFIX).c_str(), "rb");
+	if(index == NULL) {
+		return false;
+	}
+	uint32_t header[3];
+	bool ok = fread(header, sizeof(header), 1, index) == 1 and header[0] == FEATURE_INDEX_MAGIC and header[1] == FEATURE_FILE_VERSION and
+			header[2] == names.size();
+	windows.resize(names.size());
+	for(unsigned int ctg = 0; ok and ctg < windows.size(); ctg++) {
+		uint32_t size;
+		ok = fread(&size, sizeof(size), 1, index) == 1;
+		if(ok) {
+			windows[ctg].resize(size);
+			ok = size == 0 or fread(&windows[ctg][0], sizeof(int64_t), size, index) == size;
+		}
+	}
+	fclose(index);
+	return ok;
+}
+
+
+unsigned int FeatureFileReader::contigs() const {
+	return names.size();
+}
+
+string FeatureFileReader::contigName(unsigned int ctg) const {
+	return names[ctg];
+}
+
+uint32_t FeatureFileReader::contigLength(unsigned int ctg) const {
+	return lengths[ctg];
+}
+
+bool FeatureFileReader::contigId(string name, unsigned int &ctg) const {
+	map<string, unsigned int>::const_iterator id = ids.find(name);
+	if(id == ids.end()) {
+		return false;
+	}
+	ctg = id->second;
+	return true;
+}
+
+
+bool FeatureFileReader::query(unsigned int ctg, uint32_t start, uint32_t end, vector<featureRecord> &features) const {
+	features.clear();
+	const vector<int64_t> &window = windows[ctg];
+	if(window.empty() or start >= end) {
+		return true;
+	}
+	int64_t offset = window[min(start >> FEATURE_INDEX_SHIFT, (uint32_t)window.size() - 1)];
+	if(offset == -1) { // no feature from here to the contig end
+		return true;
+	}
+	BgzfStream file;
+	try {
+		file.Open(fileName, IBamIODevice::ReadOnly);
+		file.Seek(offset);
+		featureRecord record;
+		while(file.Read((char *)&record, sizeof(record)) == sizeof(record) and record.ctg == ctg and record.start < end) {
+			if(record.end > start) {
+				features.push_back(record);
+			}
+		}
+		file.Close();
+	} catch(BamException &error) {
+		cerr << error.what() << "\n";
+		return false;
+	}
+	return true;
+}
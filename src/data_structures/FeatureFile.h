@@ -0,0 +1,57 @@
+#ifndef FEATUREFILE_H_
+#define FEATUREFILE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "FRC.h"
+
+using namespace std;
+
+
+#define FEATURE_FILE_SUFFIX  "_Features.bgzf" // all the features of a run, BGZF compressed
+#define FEATURE_INDEX_SUFFIX ".fri"           // its index, next to it
+#define FEATURE_INDEX_SHIFT  14               // the index keeps an offset every 16 kbp of contig, as BAM indexes
+
+
+// a feature as stored in the feature file, contig after contig and by start on each contig
+struct featureRecord {
+	uint32_t ctg;
+	uint32_t start;
+	uint32_t end;
+	uint8_t  feature; // a FeatureTypes
+	uint8_t  library;
+	uint16_t padding;
+};
+
+
+/*
+ * Writes the suspicious areas of frc, the same of Features.txt, as featureRecords in a BGZF file and its index:
+ * for every contig and every 16 kbp window of it, the (virtual) offset of the first feature overlapping the window.
+ */
+bool writeFeatureFile(string fileName, FRC &frc);
+
+
+// features of a region of a feature file, found with a seek and a read of the features from the region start on
+class FeatureFileReader {
+	string fileName;
+	vector<string> names;
+	vector<uint32_t> lengths;
+	map<string, unsigned int> ids;
+	vector<vector<int64_t> > windows; // windows[ctg][w]: first feature overlapping window w or after it, -1 if none
+
+public:
+	bool open(string fileName); // reads the contigs and the index
+
+	unsigned int contigs() const;
+	string contigName(unsigned int ctg) const;
+	uint32_t contigLength(unsigned int ctg) const;
+	bool contigId(string name, unsigned int &ctg) const;
+
+	// features of contig ctg with start < end and end > start, by start
+	bool query(unsigned int ctg, uint32_t start, uint32_t end, vector<featureRecord> &features) const;
+};
+
+
+#endif /* FEATUREFILE_H_ */
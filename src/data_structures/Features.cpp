@@ -94,6 +94,18 @@ unsigned int Features::getHIGH_OUTIE_AREA() {return HIGH_OUTIE_AREA;}
 unsigned int Features::getCOMPRESSION_AREA() {return COMPRESSION_AREA;}
 unsigned int Features::getSTRECH_AREA() {return STRECH_AREA;}
 
+void Features::merge(const Features &other) {
+	this->LOW_COVERAGE_AREA  += other.LOW_COVERAGE_AREA;
+	this->HIGH_COVERAGE_AREA += other.HIGH_COVERAGE_AREA;
+	this->LOW_NORMAL_AREA    += other.LOW_NORMAL_AREA;
+	this->HIGH_NORMAL_AREA   += other.HIGH_NORMAL_AREA;
+	this->HIGH_SINGLE_AREA   += other.HIGH_SINGLE_AREA;
+	this->HIGH_SPANNING_AREA += other.HIGH_SPANNING_AREA;
+	this->HIGH_OUTIE_AREA    += other.HIGH_OUTIE_AREA;
+	this->COMPRESSION_AREA   += other.COMPRESSION_AREA;
+	this->STRECH_AREA        += other.STRECH_AREA;
+}
+
 unsigned int Features::returnTotal() {
 	return COMPRESSION_AREA + HIGH_COVERAGE_AREA + HIGH_NORMAL_AREA + HIGH_OUTIE_AREA +
 			HIGH_SINGLE_AREA + HIGH_SPANNING_AREA + LOW_COVERAGE_AREA + LOW_NORMAL_AREA + STRECH_AREA;
@@ -131,4 +143,65 @@ unsigned int Features::returnSTRECH(){
 
 
 
+uint64_t SuspiciousAreas::firstOf(unsigned int ctg) const {
+	return ctg < first.size() ? first[ctg] : areas.size();
+}
+
+uint64_t SuspiciousAreas::endOf(unsigned int ctg) const {
+	return ctg + 1 < first.size() ? first[ctg + 1] : areas.size();
+}
+
+
+void SuspiciousAreas::add(unsigned int ctg, const suspiciousArea &area) {
+	while(first.size() <= ctg) {
+		first.push_back(areas.size());
+	}
+	uint64_t position = endOf(ctg);
+	if(position == areas.size()) {
+		areas.push_back(area);
+		return;
+	}
+	areas.insert(areas.begin() + position, area); // a contig already passed (unsorted BAM)
+	for(unsigned int next = ctg + 1; next < first.size(); next++) {
+		first[next]++;
+	}
+}
 
+
+void SuspiciousAreas::merge(const SuspiciousAreas &other) {
+	if(other.areas.empty()) {
+		return;
+	}
+	if(areas.empty()) {
+		*this = other;
+		return;
+	}
+	unsigned int contigs = max(first.size(), other.first.size());
+	vector<suspiciousArea> merged;
+	vector<uint64_t> mergedFirst(contigs);
+	merged.reserve(areas.size() + other.areas.size());
+	for(unsigned int ctg = 0; ctg < contigs; ctg++) {
+		mergedFirst[ctg] = merged.size();
+		merged.insert(merged.end(), areas.begin() + firstOf(ctg), areas.begin() + endOf(ctg));
+		merged.insert(merged.end(), other.areas.begin() + other.firstOf(ctg), other.areas.begin() + other.endOf(ctg));
+	}
+	areas.swap(merged);
+	first.swap(mergedFirst);
+}
+
+
+vector<suspiciousArea>::iterator SuspiciousAreas::begin(unsigned int ctg) {
+	return areas.begin() + firstOf(ctg);
+}
+
+vector<suspiciousArea>::iterator SuspiciousAreas::end(unsigned int ctg) {
+	return areas.begin() + endOf(ctg);
+}
+
+vector<suspiciousArea>::const_iterator SuspiciousAreas::begin(unsigned int ctg) const {
+	return areas.begin() + firstOf(ctg);
+}
+
+vector<suspiciousArea>::const_iterator SuspiciousAreas::end(unsigned int ctg) const {
+	return areas.begin() + endOf(ctg);
+}
@@ -10,13 +10,43 @@
 
 //#include "common.h"
 #include <string>
+#include <vector>
+#include <stdint.h>
 using namespace std;
 
 
-struct ternary{
-	string feature;
-	unsigned int start;
-	unsigned int end;
+#define MAX_LIBRARIES 256 // of an assembly, their ids fit suspiciousArea::library
+
+
+// a suspicious area: its feature type (a FeatureTypes), the library that found it and where it is on the contig
+struct suspiciousArea {
+	uint8_t  feature;
+	uint8_t  library;
+	uint32_t start;
+	uint32_t end;
+};
+
+
+/*
+ * The suspicious areas of a run in a single array, contig after contig: the areas of contig ctg go from begin(ctg)
+ * to end(ctg). Contigs are usually evaluated in order, so adding an area is an append.
+ */
+class SuspiciousAreas {
+	vector<suspiciousArea> areas;
+	vector<uint64_t> first; // first[ctg]: first area of contig ctg, the contigs after the last one have none
+
+	uint64_t firstOf(unsigned int ctg) const;
+	uint64_t endOf(unsigned int ctg) const;
+
+public:
+	void add(unsigned int ctg, const suspiciousArea &area);
+	// the areas of other (found by other libraries) follow the ones of the same contig
+	void merge(const SuspiciousAreas &other);
+
+	vector<suspiciousArea>::iterator begin(unsigned int ctg);
+	vector<suspiciousArea>::iterator end(unsigned int ctg);
+	vector<suspiciousArea>::const_iterator begin(unsigned int ctg) const;
+	vector<suspiciousArea>::const_iterator end(unsigned int ctg) const;
 };
 
 
@@ -67,6 +97,8 @@ public:
 	unsigned int getCOMPRESSION_AREA();
 	unsigned int getSTRECH_AREA();
 
+	void merge(const Features &other); // adds the features found by another library
+
 	unsigned int returnTotal();
 
 	unsigned int returnLOW_COV();
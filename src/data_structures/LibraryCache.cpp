@@ -0,0 +1,142 @@
+#include "LibraryCache.h"
+#include <cstdio>
+#include <vector>
+#include <boost/crc.hpp>
+#include <boost/thread/mutex.hpp>
+
+
+#define LIBRARY_CACHE_MAGIC   0x53434652 // "FRCS"
+#define LIBRARY_CACHE_VERSION 2 // 2: counts without a running insert size estimate, the same on every path computing them
+
+// identity of the BAM file and of the parameters the counts depend on
+struct libraryCacheKey {
+	uint64_t fileSize;
+	int64_t  modificationTime;
+	uint32_t headerChecksum;
+	uint32_t max_insert;
+	uint32_t is_mp;
+	uint32_t padding; // always 0, keys are compared byte by byte
+
+	bool sameFile(const libraryCacheKey &other) const {
+		return fileSize == other.fileSize and modificationTime == other.modificationTime and headerChecksum == other.headerChecksum;
+	}
+	bool operator==(const libraryCacheKey &other) const {
+		return memcmp(this, &other, sizeof(libraryCacheKey)) == 0;
+	}
+};
+
+struct libraryCacheEntry {
+	libraryCacheKey key;
+	libraryCounts counts;
+};
+
+
+static bool computeKey(string bamFileName, uint32_t max_insert, bool is_mp, libraryCacheKey &key) {
+	memset(&key, 0, sizeof(key));
+	boost::system::error_code error;
+	key.fileSize = boost::filesystem::file_size(bamFileName, error);
+	if(error) {
+		return false;
+	}
+	key.modificationTime = boost::filesystem::last_write_time(bamFileName, error);
+	if(error) {
+		return false;
+	}
+	AlignmentReader bamFile;
+	if(!bamFile.Open(bamFileName)) {
+		return false;
+	}
+	string text = bamFile.GetHeaderText();
+	bamFile.Close();
+	boost::crc_32_type checksum;
+	checksum.process_bytes(text.data(), text.size());
+	key.headerChecksum = checksum.checksum();
+	key.max_insert     = max_insert;
+	key.is_mp          = is_mp;
+	return true;
+}
+
+
+// entries of a cache file, empty if the file is missing or was written by another version
+static vector<libraryCacheEntry> readEntries(string cacheFileName) {
+	vector<libraryCacheEntry> entries;
+	FILE *cache = fopen(cacheFileName.c_str(), "rb");
+	if(cache == NULL) {
+		return entries;
+	}
+	uint32_t header[3]; // magic, version, entry size
+	uint32_t size = 0;
+	if(fread(header, sizeof(header), 1, cache) == 1 and header[0] == LIBRARY_CACHE_MAGIC and header[1] == LIBRARY_CACHE_VERSION and
+			header[2] == sizeof(libraryCacheEntry) and fread(&size, sizeof(size), 1, cache) == 1) {
+		long start = ftell(cache);
+		long end   = fseek(cache, 0, SEEK_END) == 0 ? ftell(cache) : -1;
+		// a truncated or corrupt file is a miss, the count is checked before it is allocated
+		if(start >= 0 and end >= start and size <= (uint64_t)(end - start) / sizeof(libraryCacheEntry) and fseek(cache, start, SEEK_SET) == 0) {
+			entries.resize(size);
+			if(size > 0 and fread(&entries[0], sizeof(libraryCacheEntry), size, cache) != size) {
+				entries.clear();
+			}
+		}
+	}
+	fclose(cache);
+	return entries;
+}
+
+
+bool loadLibraryCounts(string bamFileName, uint32_t max_insert, bool is_mp, libraryCounts &counts) {
+	libraryCacheKey key;
+	if(!computeKey(bamFileName, max_insert, is_mp, key)) {
+		return false;
+	}
+	vector<libraryCacheEntry> entries = readEntries(bamFileName + LIBRARY_CACHE_SUFFIX);
+	for(unsigned int i = 0; i < entries.size(); i++) {
+		if(entries[i].key == key) {
+			counts = entries[i].counts;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// libraries evaluated at the same time can share the BAM file, and so the cache file
+static boost::mutex cacheLock;
+
+bool storeLibraryCounts(string bamFileName, uint32_t max_insert, bool is_mp, const libraryCounts &counts) {
+	boost::unique_lock<boost::mutex> guard(cacheLock);
+	libraryCacheKey key;
+	if(!computeKey(bamFileName, max_insert, is_mp, key)) {
+		return false;
+	}
+	string cacheFileName = bamFileName + LIBRARY_CACHE_SUFFIX;
+	vector<libraryCacheEntry> entries;
+	vector<libraryCacheEntry> old = readEntries(cacheFileName);
+	for(unsigned int i = 0; i < old.size(); i++) { // entries of older versions of the BAM file are dropped
+		if(old[i].key.sameFile(key) and !(old[i].key == key)) {
+			entries.push_back(old[i]);
+		}
+	}
+	libraryCacheEntry entry;
+	entry.key    = key;
+	entry.counts = counts;
+	entries.push_back(entry);
+
+	// written aside and renamed, a concurrent run never reads half a file
+	string temporaryFileName = cacheFileName + ".tmp";
+	FILE *cache = fopen(temporaryFileName.c_str(), "wb");
+	if(cache == NULL) {
+		return false;
+	}
+	uint32_t header[3] = {LIBRARY_CACHE_MAGIC, LIBRARY_CACHE_VERSION, sizeof(libraryCacheEntry)};
+	uint32_t size = entries.size();
+	fwrite(header, sizeof(header), 1, cache);
+	fwrite(&size, sizeof(size), 1, cache);
+	fwrite(&entries[0], sizeof(libraryCacheEntry), size, cache);
+	bool ok = !ferror(cache);
+	ok = fclose(cache) == 0 and ok;
+	if(!ok or rename(temporaryFileName.c_str(), cacheFileName.c_str()) != 0) {
+		remove(temporaryFileName.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,24 @@
+#ifndef LIBRARYCACHE_H_
+#define LIBRARYCACHE_H_
+
+#include <string>
+
+#include "common.h"
+
+using namespace std;
+
+
+/*
+ * Library counts (and so insert size mean and std) of a BAM file stored in a sidecar file, bamFileName + LIBRARY_CACHE_SUFFIX.
+ * An entry is valid for the BAM file with the same size, modification time and header checksum, read with the same
+ * max_insert and library type; entries of other max_insert/types are kept side by side. The counts do not depend on the
+ * genome size, the statistics are obtained from them with libraryCounts::statistics.
+ * Only counts computed on all the alignments should be stored.
+ */
+#define LIBRARY_CACHE_SUFFIX ".frcstats"
+
+bool loadLibraryCounts(string bamFileName, uint32_t max_insert, bool is_mp, libraryCounts &counts);
+bool storeLibraryCounts(string bamFileName, uint32_t max_insert, bool is_mp, const libraryCounts &counts);
+
+
+#endif /* LIBRARYCACHE_H_ */
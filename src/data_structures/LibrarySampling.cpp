@@ -0,0 +1,234 @@
+#include "LibrarySampling.h"
+#include <algorithm>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+
+// a region of a reference read as a single sample
+struct samplingBlock {
+	int refID;
+	uint32_t start;
+	uint32_t end;
+};
+
+
+// 95% interval of the mean of a Poisson distribution from count events (Wilson and Hilferty approximation)
+static double poissonLower(double count) {
+	if(count <= 0) {
+		return 0;
+	}
+	double t = 1 - 1 / (9 * count) - 1.96 / (3 * sqrt(count));
+	return t > 0 ? count * t * t * t : 0;
+}
+
+static double poissonUpper(double count) {
+	count += 1;
+	double t = 1 - 1 / (9 * count) + 1.96 / (3 * sqrt(count));
+	return count * t * t * t;
+}
+
+// 2.5% (p 0.025) or 97.5% quantile of a Poisson distribution, normal approximation for large means
+static double poissonQuantile(double mean, double p) {
+	if(mean <= 0) {
+		return 0;
+	}
+	if(mean > 100) {
+		return max(0.0, p > 0.5 ? mean + 1.96 * sqrt(mean) + 1 : mean - 1.96 * sqrt(mean));
+	}
+	double probability = exp(-mean), cumulative = probability;
+	unsigned int count = 0;
+	while(cumulative < p) {
+		count++;
+		probability *= mean / count;
+		cumulative  += probability;
+	}
+	return count;
+}
+
+
+/*
+ * 95% confidence half width of the ratio sum(y)/sum(x) over the blocks read: alignments of the same block are not
+ * independent, so the blocks are the samples. Variance of the ratio estimator, corrected for sampling without replacement,
+ * on the regular blocks. The outlier blocks (deviation from the ratio over SAMPLING_OUTLIER times the median one) are
+ * too few for it: above and below the ratio, they move it by their sum as much as the blocks not read can hold from
+ * none to many more of them, from a Poisson interval on their rate (the effective count keeps their sizes apart).
+ */
+static double ratioError(const vector<long double> &y, const vector<long double> &x, unsigned int totalBlocks) {
+	unsigned int blocks = y.size();
+	long double sumY = 0, sumX = 0;
+	for(unsigned int i = 0; i < blocks; i++) {
+		sumY += y[i];
+		sumX += x[i];
+	}
+	if(blocks < 2 or sumX == 0) {
+		return 0;
+	}
+	long double ratio = sumY / sumX;
+	vector<double> deviations; // per sqrt of the block size, the deviations of regular blocks grow with it
+	for(unsigned int i = 0; i < blocks; i++) {
+		if(x[i] > 0) {
+			deviations.push_back(fabs(y[i] - ratio * x[i]) / sqrt(x[i]));
+		}
+	}
+	nth_element(deviations.begin(), deviations.begin() + deviations.size() / 2, deviations.end());
+	double threshold = SAMPLING_OUTLIER * deviations[deviations.size() / 2];
+
+	long double regularY = 0, outliers[2] = {0, 0}, outlierSquares[2] = {0, 0}; // above and below the ratio
+	vector<long double> regular(y); // outliers replaced by blocks on the ratio
+	for(unsigned int i = 0; i < blocks; i++) {
+		long double deviation = y[i] - ratio * x[i];
+		if(x[i] > 0 and fabs(deviation) > threshold * sqrt(x[i])) {
+			outliers[deviation < 0]       += fabs(deviation);
+			outlierSquares[deviation < 0] += deviation * deviation;
+			regular[i] = ratio * x[i];
+		}
+		regularY += regular[i];
+	}
+	long double regularRatio = regularY / sumX;
+	long double residuals    = 0;
+	for(unsigned int i = 0; i < blocks; i++) {
+		residuals += (regular[i] - regularRatio * x[i]) * (regular[i] - regularRatio * x[i]);
+	}
+	long double meanX    = sumX / blocks;
+	long double variance = (1 - blocks / (long double)totalBlocks) * residuals / ((blocks - 1) * blocks * meanX * meanX);
+	double error = variance > 0 ? 1.96 * sqrt(variance) : 0;
+
+	double read = blocks / (double)totalBlocks, notRead = (1 - read) / read; // blocks not read per block read
+	double up = error, down = error;
+	for(unsigned int side = 0; side < 2; side++) {
+		if(outliers[side] == 0) {
+			continue;
+		}
+		double count = outliers[side] * outliers[side] / outlierSquares[side];
+		double part  = outliers[side] / sumX;
+		// the ratio holds part as if the blocks not read had as many outliers as the blocks read
+		double more  = max(0.0, part * (read * (1 + poissonQuantile(poissonUpper(count) * notRead, 0.975) / count) - 1));
+		double fewer = max(0.0, part * (1 - read * (1 + poissonQuantile(poissonLower(count) * notRead, 0.025) / count)));
+		up   += side == 0 ? more : fewer;
+		down += side == 0 ? fewer : more;
+	}
+	return max(up, down);
+}
+
+
+// blocks read before the first check
+static unsigned int minimumBlocks(unsigned int blocks) {
+	return max((unsigned int)SAMPLING_MIN_BLOCKS, (unsigned int)ceil(SAMPLING_MIN_FRACTION * blocks));
+}
+
+
+bool samplingPays(string bamFileName) {
+	BamReader bamFile;
+	if(!bamFile.Open(bamFileName)) {
+		return false;
+	}
+	RefVector references = bamFile.GetReferenceData();
+	bamFile.Close();
+	unsigned int blocks = 0;
+	for(unsigned int i = 0; i < references.size(); i++) {
+		blocks += (references[i].RefLength + SAMPLING_BLOCK - 1) / SAMPLING_BLOCK;
+	}
+	return minimumBlocks(blocks) <= SAMPLING_MAX_FRACTION * blocks;
+}
+
+
+LibraryStatistics sampleLibraryStats(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp, float maxError,
+		unsigned int readAhead) {
+	BamReader bamFile;
+	bamFile.SetReadAhead(readAhead);
+	bamFile.Open(bamFileName);
+	bamFile.LocateIndex();
+	RefVector references = bamFile.GetReferenceData();
+
+	vector<samplingBlock> blocks;
+	uint64_t assemblyLength = 0;
+	for(unsigned int i = 0; i < references.size(); i++) {
+		uint32_t length = references[i].RefLength;
+		assemblyLength += length;
+		for(uint32_t start = 0; start < length; start += SAMPLING_BLOCK) {
+			samplingBlock block;
+			block.refID = i;
+			block.start = start;
+			block.end   = min(length, start + SAMPLING_BLOCK);
+			blocks.push_back(block);
+		}
+	}
+	// fixed seed: the same file gives always the same estimates
+	boost::random::mt19937 generator(5489u);
+	for(unsigned int i = blocks.size(); i > 1; i--) {
+		boost::random::uniform_int_distribution<unsigned int> pick(0, i - 1);
+		swap(blocks[i - 1], blocks[pick(generator)]);
+	}
+
+	libraryCounts counts;
+	vector<long double> lengths, mapped, mated, inserts, insertsLength, insertsSquares; // sums of every block read
+	uint64_t sampledLength = 0;
+	double insertMeanError = 0, insertStdError = 0, C_A_error = 0, C_M_error = 0;
+	float insertMean = 0, insertStd = 0;
+
+	BamAlignment alignment;
+	alignmentCore al;
+	unsigned int read = 0;
+	// errors are computed over all the blocks read, once the minimum is read and then when their number grows by 10%
+	unsigned int nextCheck = minimumBlocks(blocks.size());
+	while(read < blocks.size()) {
+		const samplingBlock &block = blocks[read++];
+		libraryCounts blockCounts;
+		if(bamFile.SetRegion(block.refID, block.start, block.refID, block.end)) {
+			while ( bamFile.GetNextAlignmentCore(alignment) ) {
+				decodeAlignmentCore(alignment, al);
+				if(al.RefID == block.refID and al.Position >= (int32_t)block.start and al.Position < (int32_t)block.end) { // each alignment belongs to one block
+					blockCounts.add(al, max_insert, is_mp);
+				}
+			}
+		}
+		lengths.push_back(block.end - block.start);
+		mapped.push_back(blockCounts.mappedReadsLength);
+		mated.push_back(blockCounts.matedReadsLength);
+		inserts.push_back(blockCounts.inserts);
+		insertsLength.push_back(blockCounts.insertsLength);
+		insertsSquares.push_back(blockCounts.insertsSquares);
+		sampledLength += block.end - block.start;
+		counts.merge(blockCounts);
+
+		if(read < nextCheck and read < blocks.size()) {
+			continue;
+		}
+		nextCheck = read + read / 10 + 1;
+
+		LibraryStatistics partial = counts.statistics(genomeLength);
+		insertMean = partial.insertMean;
+		insertStd  = partial.insertStd;
+		vector<long double> deviations; // squared deviations from the current mean: their ratio to the inserts is the variance
+		for(unsigned int i = 0; i < read; i++) {
+			deviations.push_back(insertsSquares[i] - 2 * insertMean * insertsLength[i] + insertMean * insertMean * inserts[i]);
+		}
+		insertMeanError = ratioError(insertsLength, inserts, blocks.size());
+		double varianceError = ratioError(deviations, inserts, blocks.size());
+		insertStdError  = varianceError > 0 ? insertStd - sqrt(max(0.0, (double)insertStd * insertStd - varianceError)) : 0; // the wider side of the square root
+		C_A_error       = ratioError(mapped, lengths, blocks.size());
+		C_M_error       = ratioError(mated, lengths, blocks.size());
+		if(counts.inserts > 1 and
+				insertMeanError <= maxError * insertMean and insertStdError <= maxError * insertStd and
+				C_A_error <= maxError * counts.mappedReadsLength / (double)sampledLength and
+				C_M_error <= maxError * counts.matedReadsLength / (double)sampledLength) {
+			break;
+		}
+	}
+	bamFile.Close();
+	cout << "sampled " << read << " regions of " << blocks.size() << ": insert size " << insertMean << " +/- " << insertMeanError
+			<< " (std " << insertStd << " +/- " << insertStdError << ")\n";
+
+	// ratios are per assembly base, counts are scaled from the bases read to the whole assembly
+	double scale = sampledLength > 0 ? assemblyLength / (double)sampledLength : 0;
+	counts.scale(scale);
+	LibraryStatistics library = counts.statistics(genomeLength);
+	library.library_name    = libraryName(bamFileName);
+	library.sampled         = true;
+	library.sampledFraction = assemblyLength > 0 ? sampledLength / (double)assemblyLength : 0;
+	library.insertMeanError = insertMeanError;
+	library.insertStdError  = insertStdError;
+	library.C_A_error       = C_A_error * assemblyLength / genomeLength;
+	library.C_M_error       = C_M_error * assemblyLength / genomeLength;
+	return library;
+}
@@ -0,0 +1,41 @@
+#ifndef LIBRARYSAMPLING_H_
+#define LIBRARYSAMPLING_H_
+
+#include <string>
+
+#include "common.h"
+
+using namespace std;
+
+
+/*
+ * Sampled version of computeLibraryStats, requires an index (see hasBamIndex).
+ * The assembly is cut in blocks of SAMPLING_BLOCK bases that are read in random order (so contigs are picked according
+ * to their length), counting the alignments starting in each block. Reading stops as soon as the 95% confidence
+ * intervals of insert size mean and std, read coverage (C_A) and proper pairs coverage (C_M) are all within maxError
+ * times their value. Read counts and coverages are scaled to the whole assembly; unplaced reads are never sampled.
+ * The achieved bounds are stored in the returned statistics.
+ *
+ * Misassemblies make a few blocks far from the others (inserts far from the mean, no or double coverage): the bounds
+ * computed on the blocks read count these outlier blocks apart, with a Poisson interval on how many more of them the
+ * blocks not read hold. No bound can account for outlier blocks until one is read, so at least SAMPLING_MIN_BLOCKS
+ * blocks (10 Mb: with a misassembly every few hundred kb some are met) and SAMPLING_MIN_FRACTION of the assembly
+ * are read before stopping.
+ */
+#define SAMPLING_BLOCK 10000
+#define SAMPLING_MIN_BLOCKS 1000
+#define SAMPLING_MIN_FRACTION 0.01
+#define SAMPLING_OUTLIER 10 // times the median deviation of the blocks (per sqrt of their size) from the ratio
+#define SAMPLING_MAX_FRACTION 0.25 // of the assembly in the minimum sample, beyond it sampling is slower than reading all
+
+LibraryStatistics sampleLibraryStats(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp, float maxError,
+		unsigned int readAhead = 0);
+
+/*
+ * False when the minimum sample is more than SAMPLING_MAX_FRACTION of the assembly (below about 40 Mb): blocks read in
+ * random order cost more than a sequential pass, so computeLibraryStats is as fast and exact.
+ */
+bool samplingPays(string bamFileName);
+
+
+#endif /* LIBRARYSAMPLING_H_ */
@@ -0,0 +1,250 @@
+#include "RunReport.h"
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <ctime>
+#include <cstdio>
+#include <unistd.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+#include "third_party/jsoncpp/json.h"
+#include "common.h"
+
+
+#define SLOWEST_CONTIGS   10
+#define CONTIG_TIME_BINS  24 // contig times in powers of two from 1 ms, the last bin holds the slower ones
+#define FLUSH_SECONDS     1
+
+
+static const char *phaseNames[RUN_PHASES] = {"header", "statistics", "decode", "tracks", "features", "curves", "output"};
+
+struct contigTime {
+	string library;
+	string contig;
+	unsigned int length;
+	double seconds;
+};
+
+static bool slower(const contigTime &first, const contigTime &second) {
+	return first.seconds > second.seconds;
+}
+
+
+static bool reportOn = false;
+static double started;
+static boost::mutex reportLock;
+
+static double   phaseSeconds[RUN_PHASES];
+static uint64_t phaseItems[RUN_PHASES];
+static uint64_t phaseResident[RUN_PHASES]; // most resident bytes seen at the end of a lap of the phase
+static uint64_t alignments;
+static uint64_t alignmentBytes;
+static uint64_t compressedBytes;
+static uint64_t contigs;
+static uint64_t contigBases;
+static uint64_t contigBins[CONTIG_TIME_BINS];
+static vector<contigTime> slowest; // a heap, the fastest of them on top
+
+
+// resident bytes now
+static uint64_t residentMemory() {
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if(statm == NULL) {
+		return 0;
+	}
+	unsigned long int size = 0, resident = 0;
+	if(fscanf(statm, "%lu %lu", &size, &resident) != 2) {
+		resident = 0;
+	}
+	fclose(statm);
+	return (uint64_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+
+void RunReport::enable() {
+	boost::lock_guard<boost::mutex> guard(reportLock);
+	reportOn = true;
+	started  = now();
+}
+
+bool RunReport::enabled() {
+	return reportOn;
+}
+
+double RunReport::now() {
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+
+void RunReport::addPhase(RunPhase phase, double seconds, uint64_t items) {
+	if(!reportOn) {
+		return;
+	}
+	uint64_t resident = residentMemory();
+	boost::lock_guard<boost::mutex> guard(reportLock);
+	phaseSeconds[phase] += seconds;
+	phaseItems[phase]   += items;
+	phaseResident[phase] = max(phaseResident[phase], resident);
+}
+
+
+void RunReport::addReads(uint64_t alignments, uint64_t bytes, uint64_t compressedBytes) {
+	if(!reportOn) {
+		return;
+	}
+	boost::lock_guard<boost::mutex> guard(reportLock);
+	::alignments      += alignments;
+	::alignmentBytes  += bytes;
+	::compressedBytes += compressedBytes;
+}
+
+
+void RunReport::addContig(string library, string contig, unsigned int length, double seconds) {
+	if(!reportOn) {
+		return;
+	}
+	unsigned int bin = 0;
+	for(double limit = 0.001; bin + 1 < CONTIG_TIME_BINS and seconds >= limit; limit *= 2) {
+		bin++;
+	}
+	boost::lock_guard<boost::mutex> guard(reportLock);
+	contigs++;
+	contigBases += length;
+	contigBins[bin]++;
+	if(slowest.size() < SLOWEST_CONTIGS or seconds > slowest.front().seconds) {
+		contigTime time;
+		time.library = library;
+		time.contig  = contig;
+		time.length  = length;
+		time.seconds = seconds;
+		if(slowest.size() == SLOWEST_CONTIGS) {
+			pop_heap(slowest.begin(), slowest.end(), slower);
+			slowest.pop_back();
+		}
+		slowest.push_back(time);
+		push_heap(slowest.begin(), slowest.end(), slower);
+	}
+}
+
+
+bool RunReport::write(string fileName) {
+	if(!reportOn) {
+		return true;
+	}
+	boost::lock_guard<boost::mutex> guard(reportLock);
+	double wall = now() - started;
+	Json::Value report;
+	report["wall_seconds"]   = wall;
+	report["peak_rss_bytes"] = (Json::UInt)peakResidentMemory();
+
+	Json::Value &phases = report["phases"];
+	for(unsigned int phase = 0; phase < RUN_PHASES; phase++) {
+		Json::Value &entry = phases[phaseNames[phase]];
+		entry["seconds"]  = phaseSeconds[phase];
+		entry["items"]    = (Json::UInt)phaseItems[phase];
+		entry["peak_rss_bytes"] = (Json::UInt)phaseResident[phase];
+	}
+
+	Json::Value &reads = report["alignments"];
+	reads["alignments"]       = (Json::UInt)alignments;
+	reads["bytes"]            = (Json::UInt)alignmentBytes;
+	reads["compressed_bytes"] = (Json::UInt)compressedBytes;
+	reads["alignments_per_second"]     = wall > 0 ? alignments / wall : 0;
+	reads["bytes_per_second"]          = wall > 0 ? alignmentBytes / wall : 0;
+	reads["decode_alignments_per_second"] = phaseSeconds[PHASE_DECODE] > 0 ? phaseItems[PHASE_DECODE] / phaseSeconds[PHASE_DECODE] : 0;
+
+	Json::Value &contigReport = report["contigs"];
+	contigReport["contigs"]          = (Json::UInt)contigs;
+	contigReport["bases"]            = (Json::UInt)contigBases;
+	contigReport["contigs_per_second"] = wall > 0 ? contigs / wall : 0;
+	Json::Value &histogram = contigReport["seconds_histogram"]; // contigs taking less than up_to seconds (and more than the previous bin)
+	double limit = 0.001;
+	for(unsigned int bin = 0; bin < CONTIG_TIME_BINS; bin++, limit *= 2) {
+		if(contigBins[bin] == 0) {
+			continue;
+		}
+		Json::Value entry;
+		if(bin + 1 < CONTIG_TIME_BINS) {
+			entry["up_to"] = limit;
+		}
+		entry["contigs"] = (Json::UInt)contigBins[bin];
+		histogram.append(entry);
+	}
+	vector<contigTime> ranked(slowest);
+	sort(ranked.begin(), ranked.end(), slower);
+	Json::Value &slowestReport = contigReport["slowest"];
+	slowestReport = Json::Value(Json::arrayValue);
+	for(unsigned int i = 0; i < ranked.size(); i++) {
+		Json::Value entry;
+		entry["library"] = ranked[i].library;
+		entry["contig"]  = ranked[i].contig;
+		entry["length"]  = (Json::UInt)ranked[i].length;
+		entry["seconds"] = ranked[i].seconds;
+		slowestReport.append(entry);
+	}
+
+	ofstream file(fileName.c_str());
+	Json::StyledWriter writer;
+	file << writer.write(report);
+	file.close();
+	return !file.fail();
+}
+
+
+
+PhaseClock::PhaseClock() {
+	on = RunReport::enabled();
+	for(unsigned int phase = 0; phase < RUN_PHASES; phase++) {
+		seconds[phase] = 0;
+		items[phase]   = 0;
+	}
+	last          = on ? RunReport::now() : 0;
+	contigStarted = last;
+	flushed       = last;
+}
+
+PhaseClock::~PhaseClock() {
+	flush();
+}
+
+
+void PhaseClock::restart() {
+	if(on) {
+		last = RunReport::now();
+	}
+}
+
+
+void PhaseClock::contigStart() {
+	if(on) {
+		contigStarted = RunReport::now();
+	}
+}
+
+void PhaseClock::contigDone(const string &library, const string &contig, unsigned int length) {
+	if(on) {
+		double time = RunReport::now();
+		RunReport::addContig(library, contig, length, time - contigStarted);
+		if(time - flushed >= FLUSH_SECONDS) { // the resident memory of the phases is sampled at every flush
+			flush();
+		}
+	}
+}
+
+
+void PhaseClock::flush() {
+	if(!on) {
+		return;
+	}
+	flushed = RunReport::now();
+	for(unsigned int phase = 0; phase < RUN_PHASES; phase++) {
+		if(items[phase] > 0) {
+			RunReport::addPhase((RunPhase)phase, seconds[phase], items[phase]);
+			seconds[phase] = 0;
+			items[phase]   = 0;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#ifndef RUNREPORT_H_
+#define RUNREPORT_H_
+
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+
+// the phases the time of a run is split into
+enum RunPhase {
+	PHASE_HEADER,     // contigs read from the header
+	PHASE_STATISTICS, // library statistics (read, sampled or loaded)
+	PHASE_DECODE,     // alignments read and decoded in the feature pass
+	PHASE_TRACKS,     // alignments added to the contig tracks (updateContig)
+	PHASE_FEATURES,   // tracks finalized and scanned for features
+	PHASE_CURVES,     // FRCurves computed and printed
+	PHASE_OUTPUT,     // features, tables and statistics written
+	RUN_PHASES
+};
+
+
+/*
+ * Instrumentation of a run: time, items and resident memory per phase, alignments and bytes read, time per contig.
+ * It is process wide and off unless enabled; the parts of the run report to it through PhaseClocks, from any thread.
+ * Phase times are summed over the threads, rates are over the wall time of the run. write() stores it as JSON.
+ */
+class RunReport {
+public:
+	static void enable(); // starts the wall clock of the run
+	static bool enabled();
+	static double now(); // monotonic, seconds
+
+	static void addPhase(RunPhase phase, double seconds, uint64_t items);
+	// alignments and their uncompressed (BAM records or SAM text) and compressed bytes (0 if unknown)
+	static void addReads(uint64_t alignments, uint64_t bytes, uint64_t compressedBytes);
+	static void addContig(string library, string contig, unsigned int length, double seconds);
+
+	static bool write(string fileName);
+};
+
+
+/*
+ * Times the phases of one thread: every lap() charges the time since the previous one to a phase, contigStart() and
+ * contigDone() time a contig. Nothing is shared until flush(), which the destructor calls too.
+ * When the report is off every call returns at once.
+ */
+class PhaseClock {
+	bool on;
+	double last;
+	double contigStarted;
+	double flushed;
+	double seconds[RUN_PHASES];
+	uint64_t items[RUN_PHASES];
+
+public:
+	PhaseClock();
+	~PhaseClock();
+
+	inline void lap(RunPhase phase, uint64_t count = 1) {
+		if(on) {
+			double time = RunReport::now();
+			seconds[phase] += time - last;
+			items[phase]   += count;
+			last = time;
+		}
+	}
+	void restart(); // the time since the last lap is not charged to any phase
+
+	void contigStart();
+	void contigDone(const string &library, const string &contig, unsigned int length); // flushes once in a while
+
+	void flush();
+};
+
+
+#endif /* RUNREPORT_H_ */
@@ -0,0 +1,311 @@
+#include "SamReader.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <boost/bind/bind.hpp>
+
+
+#define SAM_READ_SIZE (1 << 20) // bytes of (uncompressed) text read at a time
+
+
+SamReader::SamReader() : file(NULL), eof(true), parsers(0), current(NULL), next(0), bytes(0), ordered(NULL), toParse(NULL), stopping(false) {}
+
+SamReader::~SamReader() {
+	Close();
+}
+
+
+void SamReader::SetParsers(unsigned int parsers) {
+	this->parsers = parsers;
+}
+
+
+bool SamReader::fill() {
+	if(eof) {
+		return false;
+	}
+	size_t size = pending.size();
+	pending.resize(size + SAM_READ_SIZE);
+	int bytes = gzread(file, &pending[size], SAM_READ_SIZE);
+	if(bytes <= 0) {
+		if(bytes < 0) {
+			int code;
+			cerr << "error while reading the SAM file: " << gzerror(file, &code) << "\n";
+		}
+		bytes = 0;
+		eof = true;
+	}
+	pending.resize(size + bytes);
+	return bytes > 0;
+}
+
+
+bool SamReader::readHeader() {
+	size_t start = 0;
+	while(true) {
+		if(start == pending.size()) {
+			pending.clear();
+			start = 0;
+			if(!fill()) {
+				break;
+			}
+		}
+		if(pending[start] != '@') {
+			break;
+		}
+		size_t end = pending.find('\n', start);
+		if(end == string::npos) { // a line longer than what was read
+			pending.erase(0, start);
+			start = 0;
+			if(!fill()) {
+				headerText += pending;
+				pending.clear();
+				break;
+			}
+			continue;
+		}
+		headerText.append(pending, start, end + 1 - start);
+		start = end + 1;
+	}
+	pending.erase(0, start);
+
+	SamHeader header(headerText);
+	for(SamSequenceConstIterator sequence = header.Sequences.ConstBegin(); sequence != header.Sequences.ConstEnd(); ++sequence) {
+		refIDs[sequence->Name] = references.size();
+		references.push_back(RefData(sequence->Name, atoi(sequence->Length.c_str())));
+	}
+	return true;
+}
+
+
+bool SamReader::readChunk(samChunk *chunk) {
+	while(pending.size() < SAM_CHUNK_SIZE and fill()) {}
+	size_t end = pending.rfind('\n');
+	while(end == string::npos and fill()) { // a line longer than a chunk
+		end = pending.rfind('\n');
+	}
+	if(pending.empty()) {
+		return false;
+	}
+	if(eof) { // the last line can lack its newline
+		end = pending.size() - 1;
+	}
+	chunk->text.assign(pending, 0, end + 1);
+	pending.erase(0, end + 1);
+	chunk->alignments.clear();
+	chunk->parsed = false;
+	chunk->error.clear();
+	return true;
+}
+
+
+// references of sorted files come in runs: the last one is checked first
+int32_t SamReader::refID(const char *name, size_t length, int32_t &lastID, string &lastName) const {
+	if(length == 1 and name[0] == '*') {
+		return -1;
+	}
+	if(lastID != -1 and lastName.size() == length and memcmp(lastName.data(), name, length) == 0) {
+		return lastID;
+	}
+	lastName.assign(name, length);
+	map<string, int32_t>::const_iterator id = refIDs.find(lastName);
+	lastID = id == refIDs.end() ? -2 : id->second;
+	return lastID;
+}
+
+
+static inline const char *nextField(const char *field, const char *end) {
+	const char *tab = (const char *)memchr(field, '\t', end - field);
+	return tab == NULL ? end : tab;
+}
+
+
+void SamReader::parseChunk(samChunk *chunk) const {
+	const char *line = chunk->text.data();
+	const char *textEnd = line + chunk->text.size();
+	int32_t lastID = -1;
+	string lastName;
+	alignmentCore al;
+	while(line < textEnd) {
+		const char *lineEnd = (const char *)memchr(line, '\n', textEnd - line);
+		if(lineEnd == NULL) {
+			lineEnd = textEnd;
+		}
+		const char *end = lineEnd > line and lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+		if(end == line) { // empty line
+			line = lineEnd + 1;
+			continue;
+		}
+		// QNAME FLAG RNAME POS MAPQ CIGAR RNEXT PNEXT TLEN SEQ
+		const char *fields[11];
+		fields[0] = line;
+		unsigned int found = 1;
+		for(const char *tab = nextField(line, end); found < 11 and tab < end; tab = nextField(tab + 1, end)) {
+			fields[found++] = tab + 1;
+		}
+		if(found < 10) {
+			chunk->error.assign(line, end);
+			return;
+		}
+		const char *seqEnd = found == 11 ? fields[10] - 1 : end;
+
+		al.AlignmentFlag = strtoul(fields[1], NULL, 10);
+		al.RefID         = refID(fields[2], fields[3] - 1 - fields[2], lastID, lastName);
+		al.Position      = strtol(fields[3], NULL, 10) - 1;
+		if(fields[6][0] == '=' and fields[7] - 1 - fields[6] == 1) {
+			al.MateRefID = al.RefID;
+		} else {
+			int32_t mateID = -1;
+			string mateName;
+			al.MateRefID = refID(fields[6], fields[7] - 1 - fields[6], mateID, mateName);
+		}
+		al.MatePosition  = strtol(fields[7], NULL, 10) - 1;
+		al.InsertSize    = strtol(fields[8], NULL, 10);
+		al.Length        = seqEnd - fields[9] == 1 and fields[9][0] == '*' ? 0 : seqEnd - fields[9];
+		if(al.RefID == -2 or al.MateRefID == -2) { // not in the header
+			chunk->error.assign(line, end);
+			return;
+		}
+
+		chunk->alignments.push_back(al);
+		line = lineEnd + 1;
+	}
+}
+
+
+void SamReader::readChunks() {
+	while(!stopping) {
+		samChunk *chunk = new samChunk();
+		if(!readChunk(chunk)) {
+			delete chunk;
+			break;
+		}
+		ordered->push(chunk);
+		toParse->push(chunk);
+	}
+	ordered->close();
+	toParse->close();
+}
+
+
+void SamReader::parseChunks() {
+	samChunk *chunk;
+	while(toParse->pop(chunk)) {
+		parseChunk(chunk);
+		boost::unique_lock<boost::mutex> guard(parsedLock);
+		chunk->parsed = true;
+		parsedChanged.notify_all();
+	}
+}
+
+
+samChunk *SamReader::nextChunk() {
+	if(parsers == 0) {
+		samChunk *chunk = current != NULL ? current : new samChunk();
+		if(!readChunk(chunk)) {
+			delete chunk;
+			return NULL;
+		}
+		parseChunk(chunk);
+		return chunk;
+	}
+	delete current;
+	samChunk *chunk;
+	if(!ordered->pop(chunk)) {
+		return NULL;
+	}
+	boost::unique_lock<boost::mutex> guard(parsedLock);
+	while(!chunk->parsed) {
+		parsedChanged.wait(guard);
+	}
+	return chunk;
+}
+
+
+bool SamReader::Open(string fileName) {
+	Close();
+	file = gzopen(fileName.c_str(), "rb");
+	if(file == NULL) {
+		return false;
+	}
+	gzbuffer(file, SAM_READ_SIZE);
+	eof = false;
+	stopping = false;
+	readHeader();
+	if(parsers > 0) {
+		ordered = new BoundedQueue<samChunk *>(2*parsers);
+		toParse = new BoundedQueue<samChunk *>(2*parsers);
+		reader  = boost::thread(boost::bind(&SamReader::readChunks, this));
+		for(unsigned int i = 0; i < parsers; i++) {
+			parserThreads.create_thread(boost::bind(&SamReader::parseChunks, this));
+		}
+	}
+	return true;
+}
+
+
+void SamReader::Close() {
+	if(file == NULL) {
+		return;
+	}
+	if(parsers > 0 and ordered != NULL) { // the chunks read so far are dropped
+		stopping = true;
+		samChunk *chunk;
+		while((chunk = nextChunk()) != NULL) {
+			current = chunk;
+		}
+		current = NULL;
+		reader.join();
+		parserThreads.join_all();
+		delete ordered;
+		delete toParse;
+		ordered = NULL;
+		toParse = NULL;
+	}
+	delete current;
+	current = NULL;
+	next    = 0;
+	bytes   = 0;
+	gzclose(file);
+	file = NULL;
+	eof  = true;
+	pending.clear();
+	headerText.clear();
+	references.clear();
+	refIDs.clear();
+}
+
+
+uint64_t SamReader::GetBytesRead() const {
+	return bytes;
+}
+
+string SamReader::GetHeaderText() const {
+	return headerText;
+}
+
+SamHeader SamReader::GetHeader() const {
+	return SamHeader(headerText);
+}
+
+RefVector SamReader::GetReferenceData() const {
+	return references;
+}
+
+
+bool SamReader::GetNextAlignmentCore(alignmentCore &al) {
+	while(current == NULL or next == current->alignments.size()) {
+		if(current != NULL and !current->error.empty()) {
+			cerr << "cannot read the SAM line: " << current->error << "\n";
+			exit(2);
+		}
+		current = nextChunk();
+		next    = 0;
+		if(current == NULL) {
+			return false;
+		}
+		bytes += current->text.size();
+	}
+	al = current->alignments[next++];
+	return true;
+}
@@ -0,0 +1,85 @@
+#ifndef SAMREADER_H_
+#define SAMREADER_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <zlib.h>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "api/BamAux.h"
+#include "api/SamHeader.h"
+#include "AlignmentCore.h"
+#include "BoundedQueue.h"
+
+using namespace std;
+using namespace BamTools;
+
+
+#define SAM_CHUNK_SIZE (4 << 20) // bytes of SAM text parsed at a time
+
+
+// whole SAM lines and, once parsed, their alignments
+struct samChunk {
+	string text;
+	vector<alignmentCore> alignments;
+	bool parsed;
+	string error; // the line that could not be parsed
+};
+
+
+/*
+ * Reads a SAM file, plain or gzip compressed, as alignmentCores. The text is read in chunks cut at line ends;
+ * with parsers > 0 the chunks are parsed by that many threads while the next ones are read, and handed out in
+ * file order. Method names follow BamReader.
+ */
+class SamReader {
+	gzFile file;
+	string headerText;
+	RefVector references;
+	map<string, int32_t> refIDs;
+	string pending; // text read after the last whole line
+	bool eof;
+	unsigned int parsers;
+
+	samChunk *current;
+	unsigned int next; // next alignment of current
+	uint64_t bytes;    // text of the chunks handed out
+
+	BoundedQueue<samChunk *> *ordered; // chunks in file order
+	BoundedQueue<samChunk *> *toParse;
+	boost::thread reader;
+	boost::thread_group parserThreads;
+	boost::mutex parsedLock;
+	boost::condition_variable parsedChanged;
+	bool stopping;
+
+	bool fill(); // reads more text in pending, false at the end of the file
+	bool readHeader();
+	bool readChunk(samChunk *chunk);
+	int32_t refID(const char *name, size_t length, int32_t &lastID, string &lastName) const;
+	void parseChunk(samChunk *chunk) const;
+	void readChunks();
+	void parseChunks();
+	samChunk *nextChunk(); // NULL at the end
+
+public:
+	SamReader();
+	~SamReader();
+
+	void SetParsers(unsigned int parsers); // before Open
+	bool Open(string fileName);
+	void Close();
+
+	uint64_t GetBytesRead() const; // SAM text of the alignments read so far (by whole chunks)
+	string GetHeaderText() const;
+	SamHeader GetHeader() const;
+	RefVector GetReferenceData() const;
+
+	bool GetNextAlignmentCore(alignmentCore &al); // exits on lines that are not SAM
+};
+
+
+#endif /* SAMREADER_H_ */
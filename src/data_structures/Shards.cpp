@@ -0,0 +1,318 @@
+#include "Shards.h"
+#include <sstream>
+#include <cstdio>
+#include <boost/thread/thread.hpp>
+#include <boost/bind/bind.hpp>
+#include "RunReport.h"
+
+
+vector<referenceShard> splitReferences(const RefVector &references, unsigned int shards) {
+	vector<referenceShard> split;
+	uint64_t total = 0;
+	for(unsigned int i = 0; i < references.size(); i++) {
+		total += references[i].RefLength;
+	}
+	if(shards == 0) {
+		shards = 1;
+	}
+
+	referenceShard shard;
+	shard.firstRef = 0;
+	uint64_t prefix = 0;
+	for(unsigned int i = 0; i < references.size(); i++) {
+		prefix += references[i].RefLength;
+		// a shard is closed once the references read so far reach its share of the total length
+		if(prefix * shards >= total * (split.size() + 1) or i + 1 == references.size()) {
+			shard.lastRef = i;
+			split.push_back(shard);
+			shard.firstRef = i + 1;
+		}
+	}
+	return split;
+}
+
+
+bool hasBamIndex(string bamFileName) {
+	BamReader bamFile;
+	if(!bamFile.Open(bamFileName)) {
+		return false;
+	}
+	bool found = bamFile.LocateIndex();
+	bamFile.Close();
+	return found;
+}
+
+
+ShardReader::ShardReader() {
+	this->unplaced = false;
+	this->tail     = false;
+	this->done     = true;
+	this->alignments = 0;
+	this->bytes      = 0;
+}
+
+
+bool ShardReader::open(string bamFileName, referenceShard shard, bool unplaced, unsigned int readAhead) {
+	this->shard    = shard;
+	this->unplaced = unplaced;
+	this->tail     = false;
+	this->done     = false;
+	bamFile.SetReadAhead(readAhead);
+	if(!bamFile.Open(bamFileName) or !bamFile.LocateIndex()) {
+		return false;
+	}
+	return bamFile.Jump(shard.firstRef);
+}
+
+
+// the unplaced reads follow the last placed one: the first reference with alignments before this shard
+// is a safe place to start looking for them
+bool ShardReader::findTail() {
+	for(int ref = shard.firstRef - 1; ref >= 0; ref--) {
+		alignment.RefID = -2;
+		if(bamFile.Jump(ref) and bamFile.GetNextAlignmentCore(alignment)) {
+			bamFile.ClearRegion();
+			return true;
+		}
+	}
+	return bamFile.Rewind(); // no placed reads at all
+}
+
+
+bool ShardReader::next(alignmentCore &al) {
+	while(!done) {
+		if(tail) {
+			if(!bamFile.GetNextAlignmentCore(alignment)) {
+				done = true;
+			} else if(alignment.RefID == -1) { // placed reads belong to the shard of their reference
+				return decode(al);
+			}
+			continue;
+		}
+
+		alignment.RefID = -2; // untouched if nothing is read
+		if(bamFile.GetNextAlignmentCore(alignment)) {
+			if(alignment.RefID <= shard.lastRef) {
+				return decode(al);
+			}
+			done = true; // first alignment of the next shard
+		} else if(!unplaced) {
+			done = true;
+		} else if(alignment.RefID == -1) { // the region ended on the first unplaced read
+			bamFile.ClearRegion();
+			tail = true;
+			return decode(al);
+		} else if(alignment.RefID == -2) { // no alignments on the references of the shard
+			tail = findTail();
+			done = !tail;
+		} else {
+			done = true;
+		}
+	}
+	return false;
+}
+
+
+bool ShardReader::decode(alignmentCore &al) {
+	decodeAlignmentCore(alignment, al);
+	alignments++;
+	bytes += alignment.GetBlockLength() + sizeof(uint32_t);
+	return true;
+}
+
+
+void ShardReader::close() {
+	bamFile.Close();
+	done = true;
+	RunReport::addReads(alignments, bytes, 0); // the shards read the file once: its size is counted by their caller
+	alignments = 0;
+	bytes      = 0;
+}
+
+
+static void addCompressedBytes(string bamFileName) {
+	boost::system::error_code error;
+	uint64_t size = boost::filesystem::file_size(bamFileName, error);
+	RunReport::addReads(0, 0, error ? 0 : size);
+}
+
+
+
+// a shard and everything computed on it
+struct shardJob {
+	referenceShard shard;
+	bool last;
+	bool ok;
+	libraryCounts counts;
+	TextWriter metrics;
+	vector<float> CEvalues; // of the current contig
+	CEHistogram CEstatistics; // of the shard, merged at the end
+	SuspiciousAreas areas;    // the same
+};
+
+
+static void countShard(string bamFileName, uint32_t max_insert, bool is_mp, unsigned int readAhead, shardJob *job) {
+	ShardReader reader;
+	job->ok = reader.open(bamFileName, job->shard, job->last, readAhead);
+	alignmentCore al;
+	while(job->ok and reader.next(al)) {
+		job->counts.add(al, max_insert, is_mp);
+	}
+	reader.close();
+}
+
+
+LibraryStatistics computeShardedLibraryStats(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp, unsigned int threads,
+		unsigned int readAhead, libraryCounts *countsOut) {
+	BamReader bamFile;
+	bamFile.Open(bamFileName);
+	vector<referenceShard> shards = splitReferences(bamFile.GetReferenceData(), threads);
+	bamFile.Close();
+
+	vector<shardJob *> jobs;
+	boost::thread_group pool;
+	for(unsigned int i = 0; i < shards.size(); i++) {
+		shardJob *job = new shardJob();
+		job->shard = shards[i];
+		job->last  = i + 1 == shards.size();
+		jobs.push_back(job);
+		pool.create_thread(boost::bind(&countShard, bamFileName, max_insert, is_mp, readAhead, job));
+	}
+	pool.join_all();
+	addCompressedBytes(bamFileName);
+
+	libraryCounts counts;
+	for(unsigned int i = 0; i < jobs.size(); i++) {
+		if(!jobs[i]->ok) {
+			cerr << "error while reading references " << jobs[i]->shard.firstRef << "-" << jobs[i]->shard.lastRef << " of " << bamFileName << "\n";
+		}
+		counts.merge(jobs[i]->counts);
+		delete jobs[i];
+	}
+
+	LibraryStatistics library = counts.statistics(genomeLength);
+	library.library_name = libraryName(bamFileName);
+	if(countsOut != NULL) {
+		*countsOut = counts;
+	}
+	return library;
+}
+
+
+
+// parameters shared by the shards of computeShardedFRC
+struct frcShards {
+	FRC *frc;
+	string bamFileName;
+	const RefVector *references;
+	string type;
+	bool is_mp;
+	int max_insert;
+	float CE_min;
+	float CE_max;
+	unsigned int CEwindow;
+	unsigned int binSize;
+	unsigned int readAhead;
+};
+
+
+static void storeContig(const frcShards *shards, unsigned int ctg, Contig &contig, shardJob *job) {
+	unsigned int features[TOTAL];
+	contig.finalize();
+	contig.printContigMetrics(job->metrics);
+	shards->frc->detectFeatures(shards->type, &contig, 1000, 200, shards->CE_min, shards->CE_max, shards->CEwindow, shards->CEwindow, features, job->CEvalues);
+	shards->frc->addContigFeatures(shards->type, ctg, &contig, features, job->areas); // contigs of a shard are not touched by the others
+	for(unsigned int i = 0; i < job->CEvalues.size(); i++) {
+		job->CEstatistics.add(job->CEvalues[i]);
+	}
+	job->CEvalues.clear();
+}
+
+
+static void processShard(const frcShards *shards, shardJob *job) {
+	ShardReader reader;
+	job->ok = reader.open(shards->bamFileName, job->shard, false, shards->readAhead);
+	unsigned int tracks = shards->is_mp ? MP_TRACKS : PE_TRACKS;
+	Contig contig("", 0, tracks, shards->binSize);
+	int currentContig = -1;
+	alignmentCore al;
+	PhaseClock clock;
+	string library = libraryName(shards->bamFileName);
+	while(job->ok and reader.next(al)) {
+		clock.lap(PHASE_DECODE);
+		if (!al.IsMapped()) {
+			continue;
+		}
+		if (al.RefID != currentContig) { // another contig or simply the first one of the shard
+			if(currentContig != -1) {
+				storeContig(shards, currentContig, contig, job);
+				clock.lap(PHASE_FEATURES);
+				clock.contigDone(library, (*shards->references)[currentContig].RefName, contig.getContigLength());
+			}
+			uint32_t contigSize = shards->frc->getContigLength(al.RefID);
+			if (contigSize < 1 and currentContig != -1) {//We can't have such sizes! this can't be right
+				fprintf(stderr,"%d has size %d, which can't be right!\nCheck bam header!",al.RefID,contigSize);
+			}
+			currentContig = al.RefID;
+			contig.reset((*shards->references)[currentContig].RefName, contigSize, tracks, shards->binSize);
+			clock.contigStart();
+		}
+		contig.updateContig(al, shards->max_insert, shards->is_mp);
+		clock.lap(PHASE_TRACKS);
+	}
+	if(currentContig != -1) {
+		storeContig(shards, currentContig, contig, job);
+		clock.lap(PHASE_FEATURES);
+		clock.contigDone(library, (*shards->references)[currentContig].RefName, contig.getContigLength());
+	}
+	reader.close();
+}
+
+
+bool computeShardedFRC(FRC &frc, string bamFileName, bool is_mp, int max_insert, float CE_min, float CE_max, unsigned int CEwindow,
+		unsigned int binSize, TextWriter &ContigMetricsFile, unsigned int threads, unsigned int readAhead) {
+	BamReader bamFile;
+	bamFile.Open(bamFileName);
+	RefVector references = bamFile.GetReferenceData();
+	bamFile.Close();
+
+	frcShards shards;
+	shards.frc         = &frc;
+	shards.bamFileName = bamFileName;
+	shards.references  = &references;
+	shards.type        = is_mp ? "MP" : "PE";
+	shards.is_mp       = is_mp;
+	shards.max_insert  = max_insert;
+	shards.CE_min      = CE_min;
+	shards.CE_max      = CE_max;
+	shards.CEwindow    = CEwindow;
+	shards.binSize     = binSize;
+	shards.readAhead   = readAhead;
+
+	vector<referenceShard> split = splitReferences(references, threads);
+	vector<shardJob *> jobs;
+	boost::thread_group pool;
+	for(unsigned int i = 0; i < split.size(); i++) {
+		shardJob *job = new shardJob();
+		job->shard = split[i];
+		job->last  = i + 1 == split.size();
+		jobs.push_back(job);
+		pool.create_thread(boost::bind(&processShard, &shards, job));
+	}
+	pool.join_all();
+	addCompressedBytes(bamFileName);
+
+	// shards are merged in reference order, as the serial loop reads them
+	bool ok = true;
+	for(unsigned int i = 0; i < jobs.size(); i++) {
+		if(!jobs[i]->ok) {
+			cerr << "error while reading references " << jobs[i]->shard.firstRef << "-" << jobs[i]->shard.lastRef << " of " << bamFileName << "\n";
+			ok = false;
+		}
+		ContigMetricsFile << jobs[i]->metrics.str();
+		frc.CEstatistics.merge(jobs[i]->CEstatistics);
+		frc.mergeAreas(jobs[i]->areas);
+		delete jobs[i];
+	}
+	return ok;
+}
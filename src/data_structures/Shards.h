@@ -0,0 +1,65 @@
+#ifndef SHARDS_H_
+#define SHARDS_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "FRC.h"
+
+using namespace std;
+using namespace BamTools;
+
+
+// contiguous range of references [firstRef, lastRef] processed by one thread
+struct referenceShard {
+	int firstRef;
+	int lastRef;
+};
+
+
+// splits the references in at most shards contiguous ranges of about the same total length
+vector<referenceShard> splitReferences(const RefVector &references, unsigned int shards);
+// true if the BAM file is sorted by coordinate and its index can be found
+bool hasBamIndex(string bamFileName);
+
+
+/*
+ * Reads the alignments of a shard with an own BamReader, jumping to the first reference through the index.
+ * The reader of the last shard can also return the unplaced reads stored at the end of the file.
+ */
+class ShardReader {
+	BamReader bamFile;
+	BamAlignment alignment;
+	referenceShard shard;
+	bool unplaced; // return also the unplaced reads
+	bool tail;     // reading the unplaced reads
+	bool done;
+	uint64_t alignments; // returned so far, with their BAM records
+	uint64_t bytes;
+
+	bool findTail();
+	bool decode(alignmentCore &al); // the alignment just read
+
+public:
+	ShardReader();
+
+	bool open(string bamFileName, referenceShard shard, bool unplaced, unsigned int readAhead = 0);
+	bool next(alignmentCore &al);
+	void close(); // the alignments returned go in the RunReport
+};
+
+
+/*
+ * Sharded versions of computeLibraryStats and of the computeFRC contig loop: every shard is processed by its own thread
+ * and the shard results are merged in reference order. Both require an index (see hasBamIndex).
+ * Contig features, contig table, CE statistics and library counts are the same of the serial loop.
+ * If countsOut is given it is filled with the merged library counts.
+ */
+LibraryStatistics computeShardedLibraryStats(string bamFileName, uint64_t genomeLength, uint32_t max_insert, bool is_mp, unsigned int threads,
+		unsigned int readAhead = 0, libraryCounts *countsOut = NULL);
+bool computeShardedFRC(FRC &frc, string bamFileName, bool is_mp, int max_insert, float CE_min, float CE_max, unsigned int CEwindow,
+		unsigned int binSize, TextWriter &ContigMetricsFile, unsigned int threads, unsigned int readAhead = 0);
+
+
+#endif /* SHARDS_H_ */
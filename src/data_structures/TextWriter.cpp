@@ -0,0 +1,205 @@
+#include "TextWriter.h"
+#include <cstring>
+#include <deque>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind/bind.hpp>
+
+
+#define BACKGROUND_BUFFERS 2 // full buffers waiting for the writer thread
+
+
+class BackgroundWriter {
+	FILE *file;
+	deque<string> pending;
+	bool done;
+	bool failed;
+	boost::mutex lock;
+	boost::condition_variable changed;
+	boost::thread thread;
+
+	void run() {
+		boost::unique_lock<boost::mutex> guard(lock);
+		while(true) {
+			while(pending.empty() and !done) {
+				changed.wait(guard);
+			}
+			if(pending.empty()) {
+				return;
+			}
+			string &chunk = pending.front();
+			guard.unlock(); // the front stays there, push_back does not move it
+			bool ok = fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size();
+			guard.lock();
+			failed = failed or !ok;
+			pending.pop_front();
+			changed.notify_all();
+		}
+	}
+
+public:
+	BackgroundWriter(FILE *file) : file(file), done(false), failed(false) {
+		thread = boost::thread(boost::bind(&BackgroundWriter::run, this));
+	}
+
+	// takes the content of chunk
+	void push(string &chunk) {
+		boost::unique_lock<boost::mutex> guard(lock);
+		while(pending.size() >= BACKGROUND_BUFFERS) {
+			changed.wait(guard);
+		}
+		pending.push_back(string());
+		pending.back().swap(chunk);
+		changed.notify_all();
+	}
+
+	// waits for all the chunks to be written
+	bool finish() {
+		{
+			boost::unique_lock<boost::mutex> guard(lock);
+			done = true;
+			changed.notify_all();
+		}
+		thread.join();
+		return !failed;
+	}
+};
+
+
+
+TextWriter::TextWriter() : file(NULL), writer(NULL), failed(false) {}
+
+TextWriter::~TextWriter() {
+	close();
+}
+
+
+bool TextWriter::open(string fileName, bool background) {
+	close();
+	file = fopen(fileName.c_str(), "w");
+	if(file == NULL) {
+		return false;
+	}
+	failed = false;
+	buffer.clear();
+	buffer.reserve(TEXT_WRITER_BUFFER);
+	if(background) {
+		writer = new BackgroundWriter(file);
+	}
+	return true;
+}
+
+
+bool TextWriter::close() {
+	if(file == NULL) {
+		return !failed;
+	}
+	if(!buffer.empty()) {
+		flushBuffer();
+	}
+	if(writer != NULL) {
+		failed = !writer->finish() or failed;
+		delete writer;
+		writer = NULL;
+	}
+	failed = fclose(file) != 0 or failed;
+	file = NULL;
+	string().swap(buffer);
+	return !failed;
+}
+
+
+void TextWriter::flushBuffer() {
+	if(writer != NULL) {
+		writer->push(buffer);
+		buffer.reserve(TEXT_WRITER_BUFFER);
+	} else {
+		failed = fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() or failed;
+		buffer.clear();
+	}
+}
+
+
+const string &TextWriter::str() const {
+	return buffer;
+}
+
+void TextWriter::clear() {
+	buffer.clear();
+}
+
+
+TextWriter &TextWriter::write(const char *text, size_t length) {
+	buffer.append(text, length);
+	if(file != NULL and buffer.size() >= TEXT_WRITER_BUFFER) {
+		flushBuffer();
+	}
+	return *this;
+}
+
+
+TextWriter &TextWriter::writeUnsigned(uint64_t value) {
+	char digits[20];
+	char *first = digits + sizeof(digits);
+	do {
+		*--first = '0' + value % 10;
+		value /= 10;
+	} while(value > 0);
+	return write(first, digits + sizeof(digits) - first);
+}
+
+TextWriter &TextWriter::writeSigned(int64_t value) {
+	if(value < 0) {
+		buffer.push_back('-');
+		return writeUnsigned(-(uint64_t)value);
+	}
+	return writeUnsigned(value);
+}
+
+
+TextWriter &TextWriter::operator<<(const string &text) {
+	return write(text.data(), text.size());
+}
+
+TextWriter &TextWriter::operator<<(const char *text) {
+	return write(text, strlen(text));
+}
+
+TextWriter &TextWriter::operator<<(char c) {
+	return write(&c, 1);
+}
+
+TextWriter &TextWriter::operator<<(int value) {
+	return writeSigned(value);
+}
+
+TextWriter &TextWriter::operator<<(unsigned int value) {
+	return writeUnsigned(value);
+}
+
+TextWriter &TextWriter::operator<<(long value) {
+	return writeSigned(value);
+}
+
+TextWriter &TextWriter::operator<<(unsigned long value) {
+	return writeUnsigned(value);
+}
+
+TextWriter &TextWriter::operator<<(long long value) {
+	return writeSigned(value);
+}
+
+TextWriter &TextWriter::operator<<(unsigned long long value) {
+	return writeUnsigned(value);
+}
+
+TextWriter &TextWriter::operator<<(float value) {
+	return *this << (double)value;
+}
+
+TextWriter &TextWriter::operator<<(double value) {
+	char number[32];
+	int length = snprintf(number, sizeof(number), "%g", value);
+	return write(number, length);
+}
@@ -0,0 +1,60 @@
+#ifndef TEXTWRITER_H_
+#define TEXTWRITER_H_
+
+#include <string>
+#include <cstdio>
+#include <stdint.h>
+
+using namespace std;
+
+
+#define TEXT_WRITER_BUFFER (4 << 20) // bytes formatted before a write
+
+
+class BackgroundWriter;
+
+/*
+ * Text output formatted in a large buffer and written in big chunks: integers are converted by hand, floats as
+ * printf("%g"), which is what ofstream printed them as (the program never changes the C locale). With background
+ * the full buffers are written by a thread of their own, the caller only waits if two buffers are already queued.
+ * A writer never opened just keeps the text in memory (see str), to be copied into another writer.
+ */
+class TextWriter {
+	FILE *file;
+	string buffer;
+	BackgroundWriter *writer;
+	bool failed;
+
+	TextWriter(const TextWriter &);
+	TextWriter & operator=(const TextWriter &);
+
+	void flushBuffer();
+	TextWriter &writeUnsigned(uint64_t value);
+	TextWriter &writeSigned(int64_t value);
+
+public:
+	TextWriter();
+	~TextWriter();
+
+	bool open(string fileName, bool background = false);
+	bool close(); // false if anything could not be written
+
+	const string &str() const;
+	void clear();
+
+	TextWriter &write(const char *text, size_t length);
+	TextWriter &operator<<(const string &text);
+	TextWriter &operator<<(const char *text);
+	TextWriter &operator<<(char c);
+	TextWriter &operator<<(int value);
+	TextWriter &operator<<(unsigned int value);
+	TextWriter &operator<<(long value);
+	TextWriter &operator<<(unsigned long value);
+	TextWriter &operator<<(long long value);
+	TextWriter &operator<<(unsigned long long value);
+	TextWriter &operator<<(float value);
+	TextWriter &operator<<(double value);
+};
+
+
+#endif /* TEXTWRITER_H_ */
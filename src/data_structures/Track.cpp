@@ -0,0 +1,449 @@
+#include "Track.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+
+// numbers stored 7 bits per byte, the high bit marks the bytes that are followed by another one
+static void writeNumber(FILE *file, unsigned long int value) {
+	while(value >= 0x80) {
+		putc((int)(value & 0x7F) | 0x80, file);
+		value >>= 7;
+	}
+	putc((int)value, file);
+}
+
+static bool readNumber(FILE *file, unsigned long int &value) {
+	value = 0;
+	for(unsigned int shift = 0; shift < 64; shift += 7) {
+		int byte = getc(file);
+		if(byte == EOF) {
+			return false;
+		}
+		value |= (unsigned long int)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+uint64_t TrackArena::budget   = 0;
+uint64_t TrackArena::inMemory = 0;
+string TrackArena::spillDirectory = ".";
+static boost::mutex budgetLock;
+
+
+void TrackArena::setMemoryBudget(uint64_t bytes, string spillDirectory) {
+	boost::lock_guard<boost::mutex> guard(budgetLock);
+	TrackArena::budget         = bytes;
+	TrackArena::spillDirectory = spillDirectory.empty() ? "." : spillDirectory;
+}
+
+
+bool TrackArena::reserve(size_t bytes) {
+	boost::lock_guard<boost::mutex> guard(budgetLock);
+	if(budget > 0 and inMemory + bytes > budget) {
+		return false;
+	}
+	inMemory += bytes;
+	return true;
+}
+
+void TrackArena::unreserve(size_t bytes) {
+	boost::lock_guard<boost::mutex> guard(budgetLock);
+	inMemory -= bytes;
+}
+
+
+TrackArena::TrackArena() {
+	buffer   = NULL;
+	capacity = 0;
+	dirty    = 0;
+	mapped   = false;
+	file     = -1;
+}
+
+TrackArena::~TrackArena() {
+	release();
+}
+
+
+// the file is unlinked at once: it goes away with the mapping, even if the run is killed
+bool TrackArena::mapFile(size_t bytes) {
+	string name = spillDirectory + "/FRC_track.XXXXXX";
+	vector<char> path(name.begin(), name.end());
+	path.push_back('\0');
+	file = mkstemp(&path[0]);
+	if(file == -1) {
+		return false;
+	}
+	unlink(&path[0]);
+	void *memory = MAP_FAILED;
+	if(ftruncate(file, bytes) == 0) { // a sparse file of zeroes
+		memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	}
+	if(memory == MAP_FAILED) {
+		close(file);
+		file = -1;
+		return false;
+	}
+	buffer = (uint16_t *)memory;
+	mapped = true;
+	return true;
+}
+
+
+uint16_t * TrackArena::acquire(size_t length) {
+	size_t bytes = length * sizeof(uint16_t);
+	bool reserved = length <= capacity and file != -1 and reserve(bytes); // the budget has room again: back in memory
+	if(length > capacity or reserved) { // the new memory is already zeroed
+		release(); // a file backed buffer was not reserved, the new reservation stays
+		if(!reserved and !reserve(bytes)) {
+			if(!mapFile(bytes)) {
+				cerr << "unable to map " << bytes << " bytes for a contig track in " << spillDirectory << "\n";
+				exit(EXIT_FAILURE);
+			}
+		} else if(bytes >= MMAP_THRESHOLD) {
+			void *memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if(memory == MAP_FAILED) {
+				cerr << "unable to map " << bytes << " bytes for a contig track\n";
+				exit(EXIT_FAILURE);
+			}
+			buffer = (uint16_t *)memory;
+			mapped = true;
+		} else {
+			buffer = (uint16_t *)calloc(length, sizeof(uint16_t));
+			if(buffer == NULL) {
+				cerr << "unable to allocate " << bytes << " bytes for a contig track\n";
+				exit(EXIT_FAILURE);
+			}
+		}
+		capacity = length;
+	} else if(dirty > 0) { // reuse: zero what the previous contig touched
+		size_t bytes = dirty * sizeof(uint16_t);
+		if(file != -1) { // cutting the file drops its pages, they come back as zeroes
+			if(ftruncate(file, 0) != 0 or ftruncate(file, capacity * sizeof(uint16_t)) != 0) {
+				memset(buffer, 0, bytes);
+			}
+		} else if(mapped and bytes >= MMAP_THRESHOLD) { // let the kernel hand back zero pages on the next touch
+			madvise(buffer, bytes, MADV_DONTNEED);
+		} else {
+			memset(buffer, 0, bytes);
+		}
+	}
+	dirty = length;
+	return buffer;
+}
+
+
+void TrackArena::release() {
+	if(buffer != NULL) {
+		if(mapped) {
+			munmap(buffer, capacity * sizeof(uint16_t));
+		} else {
+			free(buffer);
+		}
+		if(file != -1) {
+			close(file);
+		} else {
+			unreserve(capacity * sizeof(uint16_t));
+		}
+	}
+	buffer   = NULL;
+	capacity = 0;
+	dirty    = 0;
+	mapped   = false;
+	file     = -1;
+}
+
+
+bool TrackArena::onDisk() const {
+	return file != -1;
+}
+
+
+void TrackArena::trim(size_t start, size_t end) {
+	if(file == -1) {
+		return;
+	}
+	size_t page  = sysconf(_SC_PAGESIZE);
+	size_t first = (start * sizeof(uint16_t) + page - 1) / page * page; // whole pages only
+	size_t last  = min(end, capacity) * sizeof(uint16_t) / page * page;
+	if(last > first) { // dirty pages go to the file, not away
+		madvise((char *)buffer + first, last - first, MADV_DONTNEED);
+	}
+}
+
+
+/////////////////////
+
+
+Track::Track() {
+	counters = NULL;
+	length  = 0;
+	bases   = 0;
+	binSize = 1;
+}
+
+Track::~Track() {
+
+}
+
+
+void Track::resize(unsigned int length, unsigned int binSize) {
+	this->bases   = length;
+	this->binSize = binSize;
+	this->length  = (length + binSize - 1) / binSize;
+	counters = arena.acquire(this->length);
+	overflow.clear();
+}
+
+void Track::release() {
+	this->length = 0;
+	this->bases  = 0;
+	arena.release();
+	counters = NULL;
+	overflow.clear();
+}
+
+bool Track::empty() {
+	return this->length == 0;
+}
+
+unsigned int Track::size() {
+	return this->length;
+}
+
+unsigned int Track::getBinSize() {
+	return this->binSize;
+}
+
+
+bool Track::onDisk() const {
+	return arena.onDisk();
+}
+
+void Track::trim(unsigned int start, unsigned int end) {
+	arena.trim(binIndex(start), binIndex(end));
+}
+
+
+int Track::getDelta(unsigned int position) {
+	uint16_t delta = counters[position];
+	if(delta == DELTA_SPILL) {
+		return (int)overflow[position];
+	}
+	return (int16_t)delta;
+}
+
+
+Track::value_type Track::sum(unsigned int start, unsigned int end) const {
+	value_type total = 0;
+	unsigned int endBin = binIndex(end);
+	for(unsigned int i = binIndex(start); i < endBin; i++) {
+		total += get(i);
+	}
+	return total;
+}
+
+
+void Track::addInterval(unsigned int start, unsigned int end) {
+	if(binSize == 1) {
+		addEvent(start, +1);
+		if(end < this->bases) {
+			addEvent(end, -1);
+		}
+		return;
+	}
+	// the first and the last bin get the bases they share with the interval, the bins in between binSize each
+	unsigned int firstBin = start / binSize;
+	unsigned int lastBin  = (end - 1) / binSize;
+	if(firstBin == lastBin) {
+		addBinValue(firstBin, end - start);
+		return;
+	}
+	addBinValue(firstBin, (firstBin + 1) * binSize - start);
+	if(lastBin > firstBin + 1) {
+		addEvent(firstBin + 1, binSize);
+		addEvent(lastBin, -(int)binSize);
+	}
+	addBinValue(lastBin, end - lastBin * binSize);
+}
+
+
+void Track::addBinValue(unsigned int bin, int value) {
+	addEvent(bin, value);
+	if(bin + 1 < this->length) {
+		addEvent(bin + 1, -value);
+	}
+}
+
+
+void Track::addEvent(unsigned int position, int delta) {
+	int newDelta = getDelta(position) + delta;
+	if(newDelta > -32768 and newDelta < 32768) {
+		if(counters[position] == DELTA_SPILL) {
+			overflow.erase(position);
+		}
+		counters[position] = (uint16_t)(int16_t)newDelta;
+	} else { // delta does not fit (-32768 is the spill marker)
+		counters[position] = DELTA_SPILL;
+		overflow[position] = (unsigned int)newDelta;
+	}
+}
+
+
+void Track::materialize() {
+	long int value = 0;
+	bool trimmed = arena.onDisk(); // the counters behind the sweep are dropped from memory
+	for(unsigned int i = 0; i < this->length; i++) {
+		if(trimmed and i % TRIM_STEP == 0) {
+			arena.trim(i - min(i, TRIM_STEP), i);
+		}
+		if(counters[i] == DELTA_SPILL) {
+			value += (int)overflow[i];
+			overflow.erase(i);
+		} else {
+			value += (int16_t)counters[i];
+		}
+		if(value >= SATURATED) { // saturated counter, keep the real value in the overflow map
+			counters[i] = SATURATED;
+			overflow[i] = (unsigned int)value;
+		} else {
+			counters[i] = (uint16_t)value;
+		}
+	}
+}
+
+
+
+void Track::write(FILE *file) const {
+	fwrite(counters, sizeof(uint16_t), this->length, file);
+	writeNumber(file, overflow.size());
+	for(map<unsigned int, unsigned int>::const_iterator it = overflow.begin(); it != overflow.end(); ++it) {
+		writeNumber(file, it->first);
+		writeNumber(file, it->second);
+	}
+}
+
+bool Track::read(FILE *file) {
+	if(fread(counters, sizeof(uint16_t), this->length, file) != this->length) {
+		return false;
+	}
+	overflow.clear();
+	unsigned long int saturated, counter, value;
+	if(!readNumber(file, saturated)) {
+		return false;
+	}
+	for(unsigned long int i = 0; i < saturated; i++) {
+		if(!readNumber(file, counter) or !readNumber(file, value)) {
+			return false;
+		}
+		overflow[counter] = value;
+	}
+	return true;
+}
+
+
+
+/////////////////////
+
+InsertTrack::InsertTrack() {
+
+}
+
+InsertTrack::~InsertTrack() {
+
+}
+
+void InsertTrack::clear() {
+	runs.clear();
+}
+
+void InsertTrack::add(unsigned int position, unsigned long int insertLength) {
+	insertStart newInsert;
+	newInsert.position      = position;
+	newInsert.inserts       = 1;
+	newInsert.insertsLength = insertLength;
+	runs.push_back(newInsert);
+}
+
+
+bool sortInserts(insertStart i1, insertStart i2) {return (i1.position < i2.position);}
+
+void InsertTrack::finalize() {
+	sort(runs.begin(), runs.end(), sortInserts);
+	unsigned int merged = 0;
+	for(unsigned int i = 0; i < runs.size(); i++) {
+		if(merged > 0 and runs[merged - 1].position == runs[i].position) {
+			runs[merged - 1].inserts       += runs[i].inserts;
+			runs[merged - 1].insertsLength += runs[i].insertsLength;
+		} else {
+			runs[merged] = runs[i];
+			merged++;
+		}
+	}
+	runs.resize(merged);
+}
+
+unsigned int InsertTrack::size() const {
+	return runs.size();
+}
+
+const insertStart & InsertTrack::operator[](unsigned int i) const {
+	return runs[i];
+}
+
+
+bool insertBefore(const insertStart &i1, unsigned int position) {return (i1.position < position);}
+
+InsertTrack::value_type InsertTrack::sum(unsigned int start, unsigned int end) const {
+	value_type total;
+	vector<insertStart>::const_iterator it = lower_bound(runs.begin(), runs.end(), start, insertBefore);
+	for(; it != runs.end() and it->position < end; ++it) {
+		total.inserts       += it->inserts;
+		total.insertsLength += it->insertsLength;
+	}
+	return total;
+}
+
+
+// positions are stored as the distance from the previous insert start
+void InsertTrack::write(FILE *file) const {
+	writeNumber(file, runs.size());
+	unsigned int previous = 0;
+	for(unsigned int i = 0; i < runs.size(); i++) {
+		writeNumber(file, runs[i].position - previous);
+		writeNumber(file, runs[i].inserts);
+		writeNumber(file, runs[i].insertsLength);
+		previous = runs[i].position;
+	}
+}
+
+bool InsertTrack::read(FILE *file) {
+	runs.clear();
+	unsigned long int starts, distance, inserts, insertsLength;
+	if(!readNumber(file, starts)) {
+		return false;
+	}
+	runs.reserve(starts);
+	unsigned int position = 0;
+	for(unsigned long int i = 0; i < starts; i++) {
+		if(!readNumber(file, distance) or !readNumber(file, inserts) or !readNumber(file, insertsLength)) {
+			return false;
+		}
+		position += distance;
+		insertStart run;
+		run.position      = position;
+		run.inserts       = inserts;
+		run.insertsLength = insertsLength;
+		runs.push_back(run);
+	}
+	return true;
+}
@@ -0,0 +1,178 @@
+#ifndef TRACK_H_
+#define TRACK_H_
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdint.h>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+using namespace std;
+
+
+/*
+ * Memory of a track, reused from contig to contig. It keeps the largest buffer seen so far and, when reused,
+ * zeroes only the counters dirtied by the previous contig. Huge buffers are anonymous mappings:
+ * their pages are zeroed lazily by the kernel, both when first mapped and when a large dirty range is dropped.
+ * With a memory budget, the buffers that would take the tracks of all the arenas over it map an unlinked
+ * temporary file instead: their pages can be written back and dropped (see trim) rather than held in memory.
+ */
+class TrackArena {
+	uint16_t *buffer;
+	size_t capacity; // counters allocated
+	size_t dirty;    // counters handed out by the last acquire, to be zeroed before the next one
+	bool mapped;
+	int file;        // descriptor of the file backing buffer, -1 for memory
+
+	static const size_t MMAP_THRESHOLD = 1 << 22; // bytes
+
+	static uint64_t budget;   // bytes, 0 for no budget
+	static uint64_t inMemory; // bytes of the buffers of all the arenas not backed by a file
+	static string spillDirectory;
+
+	static bool reserve(size_t bytes); // accounts bytes in memory if they fit the budget
+	static void unreserve(size_t bytes);
+	bool mapFile(size_t bytes);
+
+	TrackArena(const TrackArena &);
+	TrackArena & operator=(const TrackArena &);
+
+public:
+	TrackArena();
+	~TrackArena();
+
+	// bytes the tracks of all the arenas may keep in memory, the other ones are mapped from files in spillDirectory
+	static void setMemoryBudget(uint64_t bytes, string spillDirectory);
+
+	uint16_t * acquire(size_t length); // zeroed buffer of at least length counters
+	void release(); // give the memory back to the system
+	bool onDisk() const;
+	void trim(size_t start, size_t end); // drops from memory the pages of counters [start, end) of a file backed buffer
+};
+
+
+/*
+ * One per-base counter track of a contig (read coverage, correctly mated coverage, ...).
+ * Values are kept in 16 bit counters, values that do not fit are saturated and spilled
+ * to a sparse overflow map.
+ * A track lives in two phases: while reads are added it stores signed events
+ * (addInterval/addEvent), materialize() turns them into per-counter values (prefix sum) that can be read with get().
+ * With a bin size larger than one every counter holds the sum of the per-base values of binSize bases
+ * (the overlap of each interval with the bin), sums are then computed on whole bins:
+ * positions are rounded down to the start of their bin.
+ */
+class Track {
+	unsigned int length; // number of counters
+	unsigned int bases;
+	unsigned int binSize;
+	TrackArena arena;
+	uint16_t *counters;
+	map<unsigned int, unsigned int> overflow;
+
+	static const uint16_t SATURATED   = 0xFFFF; // value stored in overflow (materialized track)
+	static const uint16_t DELTA_SPILL = 0x8000; // delta stored in overflow (event track)
+	static const unsigned int TRIM_STEP = 1 << 20; // counters materialized between two trims of a track on disk
+
+	Track(const Track &);
+	Track & operator=(const Track &);
+
+	int getDelta(unsigned int position);
+	void addBinValue(unsigned int bin, int value);
+
+	inline unsigned int binIndex(unsigned int position) const {
+		return position >= bases ? length : position / binSize;
+	}
+
+public:
+	Track();
+	~Track();
+
+	void resize(unsigned int length, unsigned int binSize = 1); // zeroed track of length positions, reusing the memory of the previous one
+	void release(); // free the memory used by the track
+	bool empty();
+	unsigned int size(); // number of counters
+	unsigned int getBinSize();
+
+	bool onDisk() const; // counters mapped from a file (see TrackArena)
+	void trim(unsigned int start, unsigned int end); // drops from memory the counters of the bases in [start, end) of a track on disk, values are kept
+
+	void addInterval(unsigned int start, unsigned int end); // add one to every base in [start, end)
+	void addEvent(unsigned int position, int delta); // position is a counter index
+	void materialize();
+
+	typedef unsigned long int value_type;
+	value_type sum(unsigned int start, unsigned int end) const; // sum of the values in [start, end)
+
+	void write(FILE *file) const; // stores the materialized counters
+	bool read(FILE *file); // loads counters stored by write(), the track must be resized as the stored one
+
+	inline unsigned int get(unsigned int counter) const { // value of a base (of a bin in binned tracks)
+		uint16_t value = counters[counter];
+		if(value == SATURATED) {
+			return overflow.find(counter)->second;
+		}
+		return value;
+	}
+
+};
+
+
+
+// inserts starting at position (only positions where at least one insert starts are stored)
+struct insertStart {
+	unsigned int position;
+	unsigned int inserts;
+	unsigned long int insertsLength;
+};
+
+// number and total length of the inserts starting in a range
+struct insertStatistics {
+	unsigned long int inserts;
+	unsigned long int insertsLength;
+
+	insertStatistics() : inserts(0), insertsLength(0) {}
+	insertStatistics & operator+=(const insertStatistics &other) {
+		inserts += other.inserts;
+		insertsLength += other.insertsLength;
+		return *this;
+	}
+	insertStatistics operator-(const insertStatistics &other) const {
+		insertStatistics difference;
+		difference.inserts       = inserts - other.inserts;
+		difference.insertsLength = insertsLength - other.insertsLength;
+		return difference;
+	}
+};
+
+
+/*
+ * Sparse track of the inserts starting on a contig. Inserts are appended in any order,
+ * finalize() sorts them and merges the ones starting in the same position.
+ */
+class InsertTrack {
+	vector<insertStart> runs;
+
+public:
+	InsertTrack();
+	~InsertTrack();
+
+	void clear();
+	void add(unsigned int position, unsigned long int insertLength);
+	void finalize();
+
+	unsigned int size() const;
+	const insertStart & operator[](unsigned int i) const;
+
+	typedef insertStatistics value_type;
+	value_type sum(unsigned int start, unsigned int end) const; // inserts starting in [start, end)
+
+	void write(FILE *file) const; // stores the finalized inserts
+	bool read(FILE *file);
+
+};
+
+
+
+#endif /* TRACK_H_ */
@@ -0,0 +1,205 @@
+#ifndef WINDOW_H_
+#define WINDOW_H_
+
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+
+// greatest common divisor of window size and step: every window scanned on a contig starts and ends on a multiple of it
+static inline unsigned int windowResolution(unsigned int windowSize, unsigned int windowStep) {
+	while(windowStep != 0) {
+		unsigned int rest = windowSize % windowStep;
+		windowSize = windowStep;
+		windowStep = rest;
+	}
+	return windowSize == 0 ? 1 : windowSize;
+}
+
+
+/*
+ * Cumulative sums of a track (Track, InsertTrack or anything exposing value_type and sum(start, end))
+ * sampled every resolution bases. The sum over any window whose borders lie on the grid (or on the contig end)
+ * is answered in constant time, other windows pay only for their partial blocks.
+ */
+template<class Source>
+class WindowSums {
+	typedef typename Source::value_type value_type;
+
+	const Source *source;
+	unsigned int length;
+	unsigned int resolution;
+	vector<value_type> cumulative; // cumulative[k] = sum over [0, k*resolution), the last block can be shorter
+
+	value_type prefix(unsigned int position) const {
+		if(position >= length) {
+			return cumulative.back();
+		}
+		unsigned int block = position / resolution;
+		value_type total = cumulative[block];
+		if(position % resolution != 0) {
+			total += source->sum(block * resolution, position);
+		}
+		return total;
+	}
+
+public:
+	WindowSums() : source(NULL), length(0), resolution(1), cumulative(1, value_type()) {}
+
+	WindowSums(const Source &source, unsigned int length, unsigned int resolution) {
+		build(source, length, resolution);
+	}
+
+	void build(const Source &source, unsigned int length, unsigned int resolution) {
+		start(source, length, resolution);
+		for(unsigned int blockStart = 0; blockStart < length; blockStart += resolution) {
+			addBlock(source.sum(blockStart, blockStart + resolution < length ? blockStart + resolution : length));
+		}
+	}
+
+	// builds the sums incrementally: start() and then addBlock() with the sum of every block (the last one can be shorter)
+	void start(const Source &source, unsigned int length, unsigned int resolution) {
+		this->source     = &source;
+		this->length     = length;
+		this->resolution = resolution;
+		cumulative.clear();
+		cumulative.reserve(length / resolution + 2);
+		cumulative.push_back(value_type());
+	}
+
+	void addBlock(const value_type &blockSum) {
+		value_type total = cumulative.back();
+		total += blockSum;
+		cumulative.push_back(total);
+	}
+
+	value_type sum(unsigned int start, unsigned int end) const {
+		return prefix(end) - prefix(start);
+	}
+};
+
+
+/*
+ * Slides a window of windowSize bases with step windowStep over a contig of contigLength bases and merges consecutive
+ * windows for which isFeature(start, end) holds into areas. A contig shorter than the window is a single window.
+ * When an area is closed the next window starts where the last inspected window ended.
+ * The number of features is the length of every area measured in windows (closeOffset is added to the length of the
+ * areas closed before the contig end).
+ * The scanner can be fed incrementally: advance(available) inspects only the windows lying in the first available bases,
+ * so several scanners can follow a single sweep over the contig.
+ */
+template<class Predicate>
+class WindowScanner {
+	unsigned int contigLength;
+	unsigned int windowSize;
+	unsigned int windowStep;
+	Predicate &isFeature;
+	unsigned int closeOffset;
+	vector<pair<unsigned int, unsigned int> > &areas;
+
+	unsigned int features;
+	unsigned int startWindow, endWindow;
+	unsigned int startFeat, endFeat;
+	bool feat;
+	bool started;
+	bool done;
+
+public:
+	WindowScanner(unsigned int contigLength, unsigned int windowSize, unsigned int windowStep, Predicate &isFeature,
+			unsigned int closeOffset, vector<pair<unsigned int, unsigned int> > &areas) :
+		contigLength(contigLength), windowSize(windowSize), windowStep(windowStep), isFeature(isFeature),
+		closeOffset(closeOffset), areas(areas), features(0), startWindow(0), endWindow(0), startFeat(0), endFeat(0),
+		feat(false), started(false), done(false) {}
+
+	void advance(unsigned int available) {
+		if(done) {
+			return;
+		}
+		if(!started) {
+			if(contigLength < windowSize) { // if contig less than window size, only one window
+				if(available < contigLength) {
+					return;
+				}
+				if(isFeature(0, contigLength)) { // this is a feature
+					features = 1; // one feature found (in one window)
+					areas.push_back(pair<unsigned int, unsigned int>(0, contigLength));
+				}
+				done = true;
+				return;
+			}
+			if(available < windowSize) {
+				return;
+			}
+			//otherwise compute features on sliding window
+			startWindow = 0;
+			endWindow   = windowSize;
+			if(isFeature(startWindow, endWindow)) { // in the first window already present a feature
+				startFeat = 0;
+				endFeat = windowSize;
+				feat = true; // there is an open feature
+			}
+			//now update
+			startWindow += windowStep;
+			endWindow += windowStep;
+			if(endWindow > contigLength) {
+				endWindow = contigLength;
+			}
+			started = true;
+		}
+
+		while(endWindow < contigLength and endWindow <= available) {
+			if(isFeature(startWindow, endWindow)) {
+				if(feat) { // if we are already inside a feature area
+					endFeat = endWindow; // simply extend the feature area
+				} else {
+					startFeat = startWindow;
+					endFeat = endWindow;
+					feat = true; // open feature area
+				}
+				startWindow += windowStep;
+				endWindow += windowStep;
+			} else { // this window is not affected by feature
+				if(feat) { // close the feature area and restart after the last inspected window
+					features += floor((endFeat - startFeat + closeOffset)/(float)windowSize + 0.5); // compute number of features
+					areas.push_back(pair<unsigned int, unsigned int>(startFeat, endFeat));
+					startWindow = endWindow;
+					endWindow = startWindow + windowSize;
+					feat = false; //close feature area
+				} else { // no feature was present in the window before
+					startWindow += windowStep;
+					endWindow += windowStep;
+				}
+			}
+			if(endWindow > contigLength) {
+				endWindow = contigLength;
+			}
+		}
+		if(endWindow >= contigLength) {
+			if(feat) { // a feature reached contig end
+				features += floor((endFeat - startFeat)/(float)windowSize + 0.5); // compute number of features
+				areas.push_back(pair<unsigned int, unsigned int>(startFeat, endFeat));
+				feat = false;
+			}
+			done = true;
+		}
+	}
+
+	unsigned int finish() {
+		advance(contigLength);
+		return features;
+	}
+};
+
+
+// scans a whole contig at once, returns the number of features
+template<class Predicate>
+unsigned int slideWindow(unsigned int contigLength, unsigned int windowSize, unsigned int windowStep, Predicate &isFeature,
+		unsigned int closeOffset, vector<pair<unsigned int, unsigned int> > &areas) {
+	WindowScanner<Predicate> scanner(contigLength, windowSize, windowStep, isFeature, closeOffset, areas);
+	return scanner.finish();
+}
+
+
+
+#endif /* WINDOW_H_ */